@@ -1,15 +1,69 @@
 ﻿#ifndef BASE64_HPP
 #define BASE64_HPP
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <expected>
+#if __has_include(<execution>)
+#include <execution>
+#endif
 #include <filesystem>
+#include <functional>
+#include <fstream>
+#include <iterator>
+#include <latch>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
 #include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/uio.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BASE64_POSIX_IO 1
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define BASE64_POSIX_IO 0
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define BASE64_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#else
+#define BASE64_IO_URING 0
+#endif
+
 namespace base64
 {
     /**
@@ -124,17 +178,339 @@ namespace base64
         {
             return std::unexpected(make_error_code(e));
         }
+
+        [[nodiscard]] constexpr error charset_error(
+            const std::string_view chars) noexcept
+        {
+            return chars.size() != 64
+                       ? error::invalid_character_set_length
+                       : error::invalid_character_set_padding_char_used;
+        }
+
+        [[nodiscard]] constexpr size_t encoded_size(const size_t n) noexcept
+        {
+            return (n + 2) / 3 * 4;
+        }
+
+        // Number of bytes produced by a (length-valid) encoded input
+        [[nodiscard]] constexpr size_t decoded_size(
+            const std::string_view input) noexcept
+        {
+            if (input.size() < 4)
+                return 0;
+
+            size_t padding = 0;
+            if (input.back() == '=')
+                ++padding;
+            if (input[input.size() - 2] == '=')
+                ++padding;
+            return input.size() / 4 * 3 - padding;
+        }
+
+        /**
+         * @brief Encodes input into out, which must hold encoded_size(input.size()) chars.
+         *
+         * Full triples are encoded without per-byte branches; only the
+         * trailing partial triple (if any) is padded.
+         *
+         * @return Pointer past the last written character
+         */
+        inline char* encode_into(const std::span<const std::byte> input,
+                                 char* out,
+                                 const std::string_view chars) noexcept
+        {
+            const size_t full = input.size() - input.size() % 3;
+            const auto* in = reinterpret_cast<const uint8_t*>(input.data());
+
+            for (size_t i = 0; i < full; i += 3)
+            {
+                const uint32_t triple = (static_cast<uint32_t>(in[i]) << 16) |
+                    (static_cast<uint32_t>(in[i + 1]) << 8) |
+                    static_cast<uint32_t>(in[i + 2]);
+
+                *out++ = chars[(triple >> 18) & 0x3F];
+                *out++ = chars[(triple >> 12) & 0x3F];
+                *out++ = chars[(triple >> 6) & 0x3F];
+                *out++ = chars[triple & 0x3F];
+            }
+
+            if (const size_t rest = input.size() - full; rest != 0)
+            {
+                uint32_t triple = static_cast<uint32_t>(in[full]) << 16;
+                if (rest == 2)
+                    triple |= static_cast<uint32_t>(in[full + 1]) << 8;
+
+                *out++ = chars[(triple >> 18) & 0x3F];
+                *out++ = chars[(triple >> 12) & 0x3F];
+                *out++ = rest == 2 ? chars[(triple >> 6) & 0x3F] : '=';
+                *out++ = '=';
+            }
+
+            return out;
+        }
+
+        using decode_table = std::array<uint8_t, 256>;
+
+        // Maps each alphabet character to its 6-bit value, everything else to 0xFF
+        [[nodiscard]] inline decode_table make_decode_table(
+            const std::string_view chars) noexcept
+        {
+            decode_table table{};
+            table.fill(0xFF);
+            for (uint8_t i = 0; i < 64; ++i)
+                table[static_cast<uint8_t>(chars[i])] = i;
+            return table;
+        }
+
+        /**
+         * @brief Decodes whole quads from input into out.
+         *
+         * Padding is only accepted in the final quad of the payload, which is
+         * the last quad of input when is_last is set. out must hold
+         * input.size() / 4 * 3 bytes.
+         *
+         * @return Pointer past the last written byte, or the offset of the
+         *         first invalid character within input
+         */
+        inline std::expected<std::byte*, size_t> decode_into(const std::string_view input,
+                                      std::byte* out,
+                                      const decode_table& table,
+                                      const bool is_last) noexcept
+        {
+            const auto* in = reinterpret_cast<const uint8_t*>(input.data());
+            const size_t quads = input.size() / 4;
+            const size_t plain = is_last && quads != 0 ? quads - 1 : quads;
+
+            for (size_t q = 0; q < plain; ++q, in += 4)
+            {
+                const uint8_t a = table[in[0]];
+                const uint8_t b = table[in[1]];
+                const uint8_t c = table[in[2]];
+                const uint8_t d = table[in[3]];
+
+                if ((a | b | c | d) & 0x80)
+                    return std::unexpected(
+                        q * 4 + (a & 0x80 ? 0 : b & 0x80 ? 1 : c & 0x80 ? 2 : 3));
+
+                const uint32_t chunk = (static_cast<uint32_t>(a) << 18) |
+                    (static_cast<uint32_t>(b) << 12) |
+                    (static_cast<uint32_t>(c) << 6) |
+                    static_cast<uint32_t>(d);
+
+                *out++ = static_cast<std::byte>((chunk >> 16) & 0xFF);
+                *out++ = static_cast<std::byte>((chunk >> 8) & 0xFF);
+                *out++ = static_cast<std::byte>(chunk & 0xFF);
+            }
+
+            if (plain == quads)
+                return out;
+
+            const bool pad2 = in[2] == '=';
+            const bool pad3 = in[3] == '=';
+            const uint8_t a = table[in[0]];
+            const uint8_t b = table[in[1]];
+            const uint8_t c = pad2 ? 0 : table[in[2]];
+            const uint8_t d = pad3 ? 0 : table[in[3]];
+
+            if (((a | b | c | d) & 0x80) || (pad2 && !pad3))
+                return std::unexpected(
+                    plain * 4 + (a & 0x80 ? 0 : b & 0x80 ? 1 : c & 0x80 ? 2 : 3));
+
+            const uint32_t chunk = (static_cast<uint32_t>(a) << 18) |
+                (static_cast<uint32_t>(b) << 12) |
+                (static_cast<uint32_t>(c) << 6) |
+                static_cast<uint32_t>(d);
+
+            *out++ = static_cast<std::byte>((chunk >> 16) & 0xFF);
+            if (!pad2)
+                *out++ = static_cast<std::byte>((chunk >> 8) & 0xFF);
+            if (!pad3)
+                *out++ = static_cast<std::byte>(chunk & 0xFF);
+
+            return out;
+        }
+
+        // Output block handed to sinks: small enough to stay resident in L1
+        constexpr size_t sink_block_size = 4 * 1024; // encoded characters
+
+        template <typename Sink>
+        concept encode_callback = std::invocable<Sink&, std::string_view>;
+
+        template <typename Sink>
+        concept decode_callback = std::invocable<
+            Sink&, std::span<const std::byte>>;
+    } // namespace detail
+
+    namespace detail
+    {
+        template <typename Allocator>
+        concept char_allocator = requires(Allocator& allocator, size_t n)
+        {
+            requires std::same_as<typename Allocator::value_type, char>;
+            { allocator.allocate(n) } -> std::same_as<char*>;
+        };
+
+        template <typename Allocator>
+        concept byte_allocator = requires(Allocator& allocator, size_t n)
+        {
+            requires std::same_as<typename Allocator::value_type, std::byte>;
+            { allocator.allocate(n) } -> std::same_as<std::byte*>;
+        };
+
+        // Only allocations of at least one huge page are worth mapping
+        constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+        [[nodiscard]] constexpr size_t huge_page_length(
+            const size_t bytes) noexcept
+        {
+            return (bytes + huge_page_size - 1) / huge_page_size *
+                huge_page_size;
+        }
+
+        /**
+         * @brief Maps length bytes (a multiple of huge_page_size) of anonymous memory.
+         *
+         * Reserved huge pages are tried first; without them the mapping is
+         * aligned to a huge page boundary and advised for transparent huge
+         * pages, which the kernel may or may not honour.
+         *
+         * @return Pointer to the mapping, or nullptr if no memory is left
+         */
+        [[nodiscard]] inline void* map_huge_pages(
+            [[maybe_unused]] const size_t length) noexcept
+        {
+#if BASE64_POSIX_IO
+#ifdef MAP_HUGETLB
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+            // Ask for 2MB pages explicitly so the length is always a multiple
+            flags |= 21 << MAP_HUGE_SHIFT;
+#endif
+            if (void* data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                    flags, -1, 0); data != MAP_FAILED)
+                return data;
+#endif
+            // Over-map by one huge page and trim both ends to align
+            void* mapping = ::mmap(nullptr, length + huge_page_size,
+                                   PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED)
+                return nullptr;
+
+            const auto start = reinterpret_cast<std::uintptr_t>(mapping);
+            const std::uintptr_t aligned =
+                (start + huge_page_size - 1) / huge_page_size * huge_page_size;
+            if (aligned != start)
+                ::munmap(mapping, aligned - start);
+            if (const size_t tail = huge_page_size - (aligned - start))
+                ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+
+            auto* data = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+            ::madvise(data, length, MADV_HUGEPAGE);
+#endif
+            return data;
+#else
+            return nullptr;
+#endif
+        }
     } // namespace detail
 
     /**
-     * @brief Encodes a sequence of bytes into a Base64-encoded string.
-     * 
+     * @brief Allocator backing large buffers with huge pages to cut TLB misses.
+     *
+     * Allocations of 2MB and more are mapped from reserved huge pages
+     * (MAP_HUGETLB) when available and otherwise from ordinary anonymous
+     * memory advised for transparent huge pages; smaller allocations, and
+     * all allocations on platforms without mmap, use std::allocator.
+     * Falling back never fails an allocation that std::allocator would
+     * satisfy.
+     *
+     * @tparam T Element type
+     */
+    template <typename T>
+    class huge_page_allocator
+    {
+        [[nodiscard]] static constexpr bool mapped(const size_t n) noexcept
+        {
+            return BASE64_POSIX_IO && n * sizeof(T) >= detail::huge_page_size;
+        }
+
+    public:
+        using value_type = T;
+
+        huge_page_allocator() noexcept = default;
+
+        template <typename U>
+        huge_page_allocator(const huge_page_allocator<U>&) noexcept
+        {
+        }
+
+        [[nodiscard]] T* allocate(const size_t n)
+        {
+            if (!mapped(n))
+                return std::allocator<T>{}.allocate(n);
+
+            if (n > (std::numeric_limits<size_t>::max() -
+                detail::huge_page_size) / sizeof(T))
+                throw std::bad_array_new_length();
+
+            void* data = detail::map_huge_pages(
+                detail::huge_page_length(n * sizeof(T)));
+            if (!data)
+                throw std::bad_alloc();
+            return static_cast<T*>(data);
+        }
+
+        void deallocate(T* data, const size_t n) noexcept
+        {
+#if BASE64_POSIX_IO
+            if (mapped(n))
+            {
+                ::munmap(data, detail::huge_page_length(n * sizeof(T)));
+                return;
+            }
+#endif
+            std::allocator<T>{}.deallocate(data, n);
+        }
+
+        template <typename U>
+        friend bool operator==(const huge_page_allocator&,
+                               const huge_page_allocator<U>&) noexcept
+        {
+            return true;
+        }
+    };
+
+    template <typename Allocator>
+    using basic_encode_result = std::expected<
+        std::basic_string<char, std::char_traits<char>, Allocator>,
+        std::error_code>;
+
+    using huge_page_string = std::basic_string<
+        char, std::char_traits<char>, huge_page_allocator<char>>;
+
+    template <typename Allocator>
+    using basic_decode_result = std::expected<
+        std::vector<std::byte, Allocator>, std::error_code>;
+
+    using huge_page_bytes = std::vector<
+        std::byte, huge_page_allocator<std::byte>>;
+
+    /**
+     * @brief Encodes a sequence of bytes into a string using the given allocator.
+     *
+     * Passing huge_page_allocator<char> backs large results with huge pages.
+     *
      * @param input Bytes to encode
+     * @param allocator Allocator for the encoded string
      * @param chars Character set to use (default: standard Base64)
-     * @return result Encoded string or error
+     * @return Encoded string or error
      */
-    [[nodiscard]] inline encode_result base64_encode(
+    template <detail::char_allocator Allocator>
+    [[nodiscard]] basic_encode_result<Allocator> base64_encode(
         const std::span<const std::byte> input,
+        const Allocator& allocator,
         const std::string_view chars = base64_chars)
     {
         if (input.empty())
@@ -142,47 +518,44 @@ namespace base64
 
         if (!detail::validate_charset(chars))
             return detail::make_unexpected<std::string>(
-                input.empty()
-                    ? error::empty_data
-                    : chars.size() != 64
-                    ? error::invalid_character_set_length
-                    : error::invalid_character_set_padding_char_used);
+                detail::charset_error(chars));
 
-        std::string result;
-        result.reserve(((input.size() + 2) / 3) * 4);
-
-        for (size_t i = 0; i < input.size(); i += 3)
-        {
-            uint32_t chunk = static_cast<uint32_t>(std::to_integer<uint8_t>(
-                input[i])) << 16;
-
-            if (i + 1 < input.size())
-                chunk |= static_cast<uint32_t>(std::to_integer<uint8_t>(
-                    input[i + 1])) << 8;
-            if (i + 2 < input.size())
-                chunk |= static_cast<uint32_t>(std::to_integer<uint8_t>(
-                    input[i + 2]));
-
-            result += chars[(chunk & 0x00FC0000) >> 18];
-            result += chars[(chunk & 0x0003F000) >> 12];
-            result += i + 1 < input.size()
-                          ? chars[(chunk & 0x00000FC0) >> 6]
-                          : '=';
-            result += i + 2 < input.size() ? chars[(chunk & 0x0000003F)] : '=';
-        }
+        std::basic_string<char, std::char_traits<char>, Allocator> result(
+            detail::encoded_size(input.size()), '\0', allocator);
+        detail::encode_into(input, result.data(), chars);
 
         return result;
     }
 
     /**
-     * @brief Decodes a Base64-encoded string into bytes.
+     * @brief Encodes a sequence of bytes into a Base64-encoded string.
+     *
+     * @param input Bytes to encode
+     * @param chars Character set to use (default: standard Base64)
+     * @return result Encoded string or error
+     */
+    [[nodiscard]] inline encode_result base64_encode(
+        const std::span<const std::byte> input,
+        const std::string_view chars = base64_chars)
+    {
+        return base64_encode(input, std::allocator<char>{}, chars);
+    }
+
+    /**
+     * @brief Decodes a Base64-encoded string into bytes using the given allocator.
+     *
+     * Passing huge_page_allocator<std::byte> backs large results with huge
+     * pages.
      *
      * @param input Base64-encoded string
+     * @param allocator Allocator for the decoded bytes
      * @param chars Character set to use (default: standard Base64)
-     * @return decode_result Decoded bytes or error
+     * @return Decoded bytes or error
      */
-    [[nodiscard]] inline decode_result base64_decode(
+    template <detail::byte_allocator Allocator>
+    [[nodiscard]] basic_decode_result<Allocator> base64_decode(
         const std::string_view input,
+        const Allocator& allocator,
         const std::string_view chars = base64_chars)
     {
         if (input.empty())
@@ -199,273 +572,6150 @@ namespace base64
             return detail::make_unexpected<std::vector<std::byte>>(
                 error::invalid_length);
 
-        // Create decode lookup table
-        std::array<uint8_t, 256> decode_table{};
-        decode_table.fill(0xFF);
-        for (uint8_t i = 0; i < 64; ++i)
-            decode_table[static_cast<uint8_t>(chars[i])] = i;
-        decode_table[static_cast<uint8_t>('=')] = 0;
+        const auto table = detail::make_decode_table(chars);
+
+        std::vector<std::byte, Allocator> result(detail::decoded_size(input),
+                                                 allocator);
+        if (!detail::decode_into(input, result.data(), table, true))
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::invalid_character);
+
+        return result;
+    }
+
+    /**
+     * @brief Decodes a Base64-encoded string into bytes.
+     *
+     * @param input Base64-encoded string
+     * @param chars Character set to use (default: standard Base64)
+     * @return decode_result Decoded bytes or error
+     */
+    [[nodiscard]] inline decode_result base64_decode(
+        const std::string_view input,
+        const std::string_view chars = base64_chars)
+    {
+        return base64_decode(input, std::allocator<std::byte>{}, chars);
+    }
+
+    /**
+     * @brief Encodes bytes into Base64, handing the output to a callback block by block.
+     *
+     * The callback receives consecutive blocks of at most 4KB that are only
+     * valid for the duration of the call, so no output proportional to the
+     * input is ever materialized.
+     *
+     * @param input Bytes to encode
+     * @param sink Callable invoked as sink(std::string_view) for each block
+     * @param chars Character set to use (default: standard Base64)
+     * @return std::error_code Error code (empty if successful)
+     */
+    template <detail::encode_callback Sink>
+    [[nodiscard]] std::error_code base64_encode(
+        const std::span<const std::byte> input,
+        Sink&& sink,
+        const std::string_view chars = base64_chars)
+    {
+        if (input.empty())
+            return make_error_code(error::empty_data);
+
+        if (!detail::validate_charset(chars))
+            return make_error_code(detail::charset_error(chars));
 
-        std::vector<std::byte> result;
-        result.reserve((input.size() * 3) / 4);
+        constexpr size_t block_input = detail::sink_block_size / 4 * 3;
+        std::array<char, detail::sink_block_size> block;
 
-        for (size_t i = 0; i < input.size(); i += 4)
+        for (size_t offset = 0; offset < input.size(); offset += block_input)
         {
-            const std::array<uint8_t, 4> v{
-                decode_table[static_cast<uint8_t>(input[i])],
-                decode_table[static_cast<uint8_t>(input[i + 1])],
-                decode_table[static_cast<uint8_t>(input[i + 2])],
-                decode_table[static_cast<uint8_t>(input[i + 3])]
-            };
+            const auto part = input.subspan(
+                offset, std::min(block_input, input.size() - offset));
+            const char* end = detail::encode_into(part, block.data(), chars);
+            sink(std::string_view(block.data(), end));
+        }
 
-            if (v[0] == 0xFF || v[1] == 0xFF ||
-                (input[i + 2] != '=' && v[2] == 0xFF) ||
-                (input[i + 3] != '=' && v[3] == 0xFF))
+        return {};
+    }
+
+    /**
+     * @brief Encodes bytes into Base64, writing the characters through an output iterator.
+     *
+     * @param input Bytes to encode
+     * @param out Output iterator accepting char
+     * @param chars Character set to use (default: standard Base64)
+     * @return Iterator past the last written character or error
+     */
+    template <std::output_iterator<char> OutIt>
+    [[nodiscard]] std::expected<OutIt, std::error_code> base64_encode(
+        const std::span<const std::byte> input,
+        OutIt out,
+        const std::string_view chars = base64_chars)
+    {
+        if (const auto ec = base64_encode(
+            input,
+            [&out](const std::string_view block)
             {
-                return detail::make_unexpected<std::vector<std::byte>>(
-                    error::invalid_character);
-            }
+                out = std::copy(block.begin(), block.end(), std::move(out));
+            },
+            chars))
+            return std::unexpected(ec);
+
+        return out;
+    }
+
+    /**
+     * @brief Decodes a Base64-encoded string, handing the bytes to a callback block by block.
+     *
+     * Input is decoded in 4KB blocks and each block is passed on before the
+     * next is read. On an invalid character the blocks preceding it have
+     * already been delivered, and the error is returned.
+     *
+     * @param input Base64-encoded string
+     * @param sink Callable invoked as sink(std::span<const std::byte>) for each block
+     * @param chars Character set to use (default: standard Base64)
+     * @return std::error_code Error code (empty if successful)
+     */
+    template <detail::decode_callback Sink>
+    [[nodiscard]] std::error_code base64_decode(
+        const std::string_view input,
+        Sink&& sink,
+        const std::string_view chars = base64_chars)
+    {
+        if (input.empty())
+            return make_error_code(error::empty_data);
+
+        if (!detail::validate_charset(chars))
+            return make_error_code(detail::charset_error(chars));
+
+        if (input.size() % 4 != 0)
+            return make_error_code(error::invalid_length);
+
+        const auto table = detail::make_decode_table(chars);
+        std::array<std::byte, detail::sink_block_size / 4 * 3> block;
+
+        for (size_t offset = 0; offset < input.size();
+             offset += detail::sink_block_size)
+        {
+            const auto part = input.substr(offset, detail::sink_block_size);
+            const bool is_last = offset + part.size() == input.size();
 
-            const uint32_t chunk = (static_cast<uint32_t>(v[0]) << 18) |
-                (static_cast<uint32_t>(v[1]) << 12) |
-                (static_cast<uint32_t>(v[2]) << 6) |
-                static_cast<uint32_t>(v[3]);
+            const auto end = detail::decode_into(
+                part, block.data(), table, is_last);
+            if (!end)
+                return make_error_code(error::invalid_character);
 
-            result.push_back(static_cast<std::byte>((chunk >> 16) & 0xFF));
-            if (input[i + 2] != '=')
-                result.push_back(static_cast<std::byte>((chunk >> 8) & 0xFF));
-            if (input[i + 3] != '=')
-                result.push_back(static_cast<std::byte>(chunk & 0xFF));
+            sink(std::span<const std::byte>(block.data(), *end));
         }
 
-        return result;
+        return {};
+    }
+
+    /**
+     * @brief Decodes a Base64-encoded string, writing the bytes through an output iterator.
+     *
+     * @param input Base64-encoded string
+     * @param out Output iterator accepting std::byte
+     * @param chars Character set to use (default: standard Base64)
+     * @return Iterator past the last written byte or error
+     */
+    template <std::output_iterator<std::byte> OutIt>
+    [[nodiscard]] std::expected<OutIt, std::error_code> base64_decode(
+        const std::string_view input,
+        OutIt out,
+        const std::string_view chars = base64_chars)
+    {
+        if (const auto ec = base64_decode(
+            input,
+            [&out](const std::span<const std::byte> block)
+            {
+                out = std::copy(block.begin(), block.end(), std::move(out));
+            },
+            chars))
+            return std::unexpected(ec);
+
+        return out;
     }
 
+    /**
+     * @brief Controls how the parallel encode/decode overloads split their work.
+     *
+     * @var threads   Number of worker threads (0: std::thread::hardware_concurrency())
+     * @var threshold Inputs smaller than this many bytes stay on the calling thread
+     */
+    struct parallel_options
+    {
+        unsigned threads = 0;
+        size_t threshold = 1024 * 1024;
+    };
+
     namespace detail
     {
-        // Optimal chunk size (multiple of 3 for base64 encoding efficiency)
-        constexpr size_t default_chunk_size = 48 * 1024; // 48KB chunks
+        // Smallest slice worth handing to a separate thread
+        constexpr size_t min_parallel_slice = 64 * 1024;
 
-        class stream_encoder
+        [[nodiscard]] inline unsigned resolve_workers(
+            const parallel_options& options,
+            const size_t input_size) noexcept
         {
-            std::vector<std::byte> buffer_;
-            std::string result_;
-            const std::string_view chars_;
-            const size_t chunk_size_;
-
-        public:
-            explicit stream_encoder(const size_t reserved_size,
-                                    const std::string_view chars = base64_chars,
-                                    const size_t chunk_size =
-                                        default_chunk_size)
-                : buffer_(chunk_size)
-                  , chars_(chars)
-                  , chunk_size_(chunk_size)
-            {
-                // Reserve estimated final size plus some padding
-                result_.reserve((reserved_size + 2) / 3 * 4);
-            }
+            if (input_size < options.threshold)
+                return 1;
 
-            void process_chunk(const std::span<const std::byte> chunk)
-            {
-                for (size_t i = 0; i < chunk.size(); i += 3)
-                {
-                    uint32_t triple = static_cast<uint32_t>(std::to_integer<
-                        uint8_t>(chunk[i])) << 16;
+            unsigned workers = options.threads != 0
+                                   ? options.threads
+                                   : std::thread::hardware_concurrency();
+            workers = std::max(workers, 1u);
 
-                    if (i + 1 < chunk.size())
-                        triple |= static_cast<uint32_t>(std::to_integer<
-                            uint8_t>(chunk[i + 1])) << 8;
-                    if (i + 2 < chunk.size())
-                        triple |= static_cast<uint32_t>(std::to_integer<
-                            uint8_t>(chunk[i + 2]));
+            const size_t max_useful = std::max<size_t>(
+                input_size / min_parallel_slice, 1);
+            return static_cast<unsigned>(std::min<size_t>(workers,
+                max_useful));
+        }
 
-                    result_ += chars_[(triple & 0x00FC0000) >> 18];
-                    result_ += chars_[(triple & 0x0003F000) >> 12];
-                    result_ += (i + 1 < chunk.size())
-                                   ? chars_[(triple & 0x00000FC0) >> 6]
-                                   : '=';
-                    result_ += (i + 2 < chunk.size())
-                                   ? chars_[(triple & 0x0000003F)]
-                                   : '=';
-                }
-            }
+        /**
+         * @brief Splits [0, units) into contiguous ranges and runs fn(first, last) on each.
+         *
+         * The last range runs on the calling thread; the others on threads
+         * that are joined before returning.
+         */
+        template <typename Fn>
+        void parallel_for_ranges(const size_t units,
+                                 const unsigned workers,
+                                 Fn&& fn)
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(workers - 1);
 
-            [[nodiscard]] std::string&& finalize() &&
-            {
-                return std::move(result_);
-            }
+            const size_t per_worker = units / workers;
+            const size_t extra = units % workers;
+            size_t first = 0;
 
-            [[nodiscard]] std::span<std::byte> get_buffer() noexcept
+            for (unsigned w = 0; w < workers; ++w)
             {
-                return {buffer_.data(), buffer_.size()};
+                const size_t last = first + per_worker + (w < extra ? 1 : 0);
+                if (w + 1 == workers)
+                    fn(first, last);
+                else
+                    threads.emplace_back([&fn, first, last]
+                    {
+                        fn(first, last);
+                    });
+                first = last;
             }
-        };
+        }
     } // namespace detail
 
     /**
-     * @brief Encodes a file into a Base64-encoded string using streaming.
+     * @brief Encodes bytes into Base64 using multiple threads.
      *
-     * This implementation:
-     * - Uses chunked reading for memory efficiency
-     * - Pre-allocates buffers for optimal performance
-     * - Avoids unnecessary memory reallocations
-     * - Processes data in a streaming fashion
+     * The input is split at 3-byte boundaries and every worker encodes its
+     * slice straight into the matching region of the pre-sized result.
+     * Inputs below options.threshold are encoded on the calling thread.
      *
-     * @param path Path to the file to encode
+     * @param input Bytes to encode
+     * @param options Thread count and single-thread threshold
      * @param chars Character set to use (default: standard Base64)
-     * @param chunk_size Size of chunks to read (default: 48KB)
-     * @param max_size Maximum file size to process (default: 100MB)
      * @return encode_result Encoded string or error
      */
-    [[nodiscard]] inline encode_result base64_encode_file(
-        const std::filesystem::path& path,
-        const std::string_view chars = base64_chars,
-        const size_t chunk_size = detail::default_chunk_size,
-        const std::uintmax_t max_size = 100 * 1024 * 1024)
+    [[nodiscard]] inline encode_result base64_encode(
+        const std::span<const std::byte> input,
+        const parallel_options& options,
+        const std::string_view chars = base64_chars)
     {
-        // Validate input parameters
+        if (input.empty())
+            return detail::make_unexpected<std::string>(error::empty_data);
+
         if (!detail::validate_charset(chars))
             return detail::make_unexpected<std::string>(
-                chars.size() != 64
-                    ? error::invalid_character_set_length
-                    : error::invalid_character_set_padding_char_used);
+                detail::charset_error(chars));
 
-        // Validate file
-        std::error_code ec;
-        if (!std::filesystem::exists(path))
-            return detail::make_unexpected<std::string>(error::file_not_found);
+        const unsigned workers = detail::resolve_workers(options, input.size());
+        const size_t triples = (input.size() + 2) / 3;
 
-        const auto file_size = std::filesystem::file_size(path, ec);
-        if (ec)
-            return detail::make_unexpected<std::string>(error::io_error);
+        std::string result(detail::encoded_size(input.size()), '\0');
 
-        if (file_size == 0)
-            return detail::make_unexpected<std::string>(error::empty_data);
+        detail::parallel_for_ranges(
+            triples, workers,
+            [&](const size_t first, const size_t last)
+            {
+                const size_t begin = first * 3;
+                const size_t end = std::min(last * 3, input.size());
+                detail::encode_into(input.subspan(begin, end - begin),
+                                    result.data() + first * 4, chars);
+            });
 
-        if (file_size > max_size)
-            return detail::make_unexpected<std::string>(error::file_too_large);
+        return result;
+    }
 
-        // Open a file with exception handling
-        std::ifstream file(path, std::ios::binary);
-        if (!file.is_open())
-            return detail::make_unexpected<std::string>(
-                error::file_not_readable);
+    /**
+     * @brief Decodes a Base64-encoded string using multiple threads.
+     *
+     * The input is split at 4-character boundaries and every worker decodes
+     * its slice straight into the matching region of the pre-sized result.
+     * Inputs below options.threshold are decoded on the calling thread.
+     *
+     * @param input Base64-encoded string
+     * @param options Thread count and single-thread threshold
+     * @param chars Character set to use (default: standard Base64)
+     * @return decode_result Decoded bytes or error
+     */
+    [[nodiscard]] inline decode_result base64_decode(
+        const std::string_view input,
+        const parallel_options& options,
+        const std::string_view chars = base64_chars)
+    {
+        if (input.empty())
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::empty_data);
 
-        try
+        if (!detail::validate_charset(chars))
+            return detail::make_unexpected<std::vector<std::byte>>(
+                detail::charset_error(chars));
+
+        if (input.size() % 4 != 0)
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::invalid_length);
+
+        const auto table = detail::make_decode_table(chars);
+        const unsigned workers = detail::resolve_workers(options, input.size());
+        const size_t quads = input.size() / 4;
+
+        std::vector<std::byte> result(detail::decoded_size(input));
+        std::atomic<bool> invalid{false};
+
+        detail::parallel_for_ranges(
+            quads, workers,
+            [&](const size_t first, const size_t last)
+            {
+                const auto slice = input.substr(first * 4, (last - first) * 4);
+                if (!detail::decode_into(slice, result.data() + first * 3,
+                                         table, last == quads))
+                    invalid.store(true, std::memory_order_relaxed);
+            });
+
+        if (invalid.load(std::memory_order_relaxed))
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::invalid_character);
+
+        return result;
+    }
+
+    /**
+     * @brief Arrow-style string column: row i is data[offsets[i], offsets[i + 1]).
+     */
+    template <typename Offset>
+    struct encoded_column
+    {
+        std::string data;
+        std::vector<Offset> offsets;
+    };
+
+    /**
+     * @brief Arrow-style binary column: row i is data[offsets[i], offsets[i + 1]).
+     */
+    template <typename Offset>
+    struct decoded_column
+    {
+        std::vector<std::byte> data;
+        std::vector<Offset> offsets;
+    };
+
+    template <typename Offset>
+    using encode_column_result = std::expected<encoded_column<Offset>,
+                                               std::error_code>;
+
+    template <typename Offset>
+    using decode_column_result = std::expected<decoded_column<Offset>,
+                                               std::error_code>;
+
+    namespace detail
+    {
+        // Offsets must start at or after 0, never decrease and stay inside data
+        template <typename Offset>
+        [[nodiscard]] bool validate_offsets(const std::span<const Offset> offsets,
+                                            const size_t data_size) noexcept
         {
-            // Setup streaming encoder with pre-allocated buffers
-            detail::stream_encoder encoder(file_size, chars, chunk_size);
+            if (offsets.empty() || offsets.front() < 0 ||
+                static_cast<std::make_unsigned_t<Offset>>(offsets.back()) >
+                data_size)
+                return false;
 
-            // Process file in chunks
-            while (file && !file.eof())
+            return std::ranges::is_sorted(offsets);
+        }
+
+        /**
+         * @brief Runs fn(first_row, last_row) over row ranges holding similar byte counts.
+         */
+        template <typename Offset, typename Fn>
+        void for_each_row_range(const std::span<const Offset> offsets,
+                                const parallel_options& options,
+                                Fn&& fn)
+        {
+            const size_t rows = offsets.size() - 1;
+            const auto first_byte = offsets.front();
+            const auto total = static_cast<size_t>(offsets.back() - first_byte);
+            const auto workers = static_cast<unsigned>(std::min<size_t>(
+                resolve_workers(options, total), std::max<size_t>(rows, 1)));
+
+            const auto split = [&](const size_t w)
             {
-                auto buffer = encoder.get_buffer();
-                file.read(reinterpret_cast<char*>(buffer.data()),
-                          static_cast<std::streamsize>(buffer.size()));
+                if (w == workers)
+                    return rows;
+                const auto target = static_cast<Offset>(
+                    first_byte + static_cast<Offset>(total / workers * w));
+                return static_cast<size_t>(std::ranges::lower_bound(
+                    offsets.first(rows), target) - offsets.begin());
+            };
 
-                if (const auto bytes_read = file.gcount(); bytes_read > 0)
-                {
-                    encoder.process_chunk(std::span(buffer.data(), bytes_read));
-                }
+            parallel_for_ranges(workers, workers,
+                                [&](const size_t w, const size_t)
+                                {
+                                    fn(split(w), split(w + 1));
+                                });
+        }
+
+        template <typename Offset>
+        [[nodiscard]] encode_column_result<Offset> encode_column(
+            const std::span<const std::byte> data,
+            const std::span<const Offset> offsets,
+            const std::string_view chars,
+            const parallel_options& options)
+        {
+            if (!validate_charset(chars))
+                return std::unexpected(make_error_code(charset_error(chars)));
+
+            if (!validate_offsets(offsets, data.size()))
+                return std::unexpected(make_error_code(error::invalid_length));
+
+            // Output offsets are the prefix sum of the encoded row sizes
+            encoded_column<Offset> column;
+            column.offsets.resize(offsets.size());
+            size_t total = 0;
+            for (size_t row = 0; row + 1 < offsets.size(); ++row)
+            {
+                total += encoded_size(
+                    static_cast<size_t>(offsets[row + 1] - offsets[row]));
+                column.offsets[row + 1] = static_cast<Offset>(total);
             }
 
-            // Check for read errors
-            if (file.bad())
-                return detail::make_unexpected<std::string>(error::io_error);
+            if (total > static_cast<size_t>(std::numeric_limits<Offset>::max()))
+                return std::unexpected(make_error_code(error::invalid_length));
 
-            // Finalize and return the result
-            return std::move(encoder).finalize();
+            column.data.resize(total);
+            for_each_row_range(
+                offsets, options,
+                [&](const size_t first, const size_t last)
+                {
+                    for (size_t row = first; row < last; ++row)
+                    {
+                        const auto begin = static_cast<size_t>(offsets[row]);
+                        const auto end = static_cast<size_t>(offsets[row + 1]);
+                        encode_into(data.subspan(begin, end - begin),
+                                    column.data.data() + column.offsets[row],
+                                    chars);
+                    }
+                });
+
+            return column;
         }
-        catch (const std::exception&)
+
+        template <typename Offset>
+        [[nodiscard]] decode_column_result<Offset> decode_column(
+            const std::string_view data,
+            const std::span<const Offset> offsets,
+            const std::string_view chars,
+            const parallel_options& options)
         {
-            return detail::make_unexpected<std::string>(error::io_error);
+            if (!validate_charset(chars))
+                return std::unexpected(make_error_code(charset_error(chars)));
+
+            if (!validate_offsets(offsets, data.size()))
+                return std::unexpected(make_error_code(error::invalid_length));
+
+            decoded_column<Offset> column;
+            column.offsets.resize(offsets.size());
+            size_t total = 0;
+            for (size_t row = 0; row + 1 < offsets.size(); ++row)
+            {
+                const auto encoded = data.substr(
+                    static_cast<size_t>(offsets[row]),
+                    static_cast<size_t>(offsets[row + 1] - offsets[row]));
+                if (encoded.size() % 4 != 0)
+                    return std::unexpected(
+                        make_error_code(error::invalid_length));
+
+                total += decoded_size(encoded);
+                column.offsets[row + 1] = static_cast<Offset>(total);
+            }
+
+            column.data.resize(total);
+            std::atomic<bool> invalid{false};
+            const auto table = make_decode_table(chars);
+
+            for_each_row_range(
+                offsets, options,
+                [&](const size_t first, const size_t last)
+                {
+                    for (size_t row = first; row < last; ++row)
+                    {
+                        const auto encoded = data.substr(
+                            static_cast<size_t>(offsets[row]),
+                            static_cast<size_t>(offsets[row + 1] - offsets[
+                                row]));
+                        if (encoded.empty())
+                            continue;
+
+                        if (!decode_into(encoded,
+                                         column.data.data() + column.offsets[
+                                             row],
+                                         table, true))
+                        {
+                            invalid.store(true, std::memory_order_relaxed);
+                            return;
+                        }
+                    }
+                });
+
+            if (invalid.load(std::memory_order_relaxed))
+                return std::unexpected(make_error_code(error::invalid_character));
+
+            return column;
         }
+    } // namespace detail
+
+    /**
+     * @brief Encodes every row of an Arrow-style binary column (32-bit offsets).
+     *
+     * Output offsets are computed up front as a prefix sum of the encoded
+     * row sizes, then all rows are encoded in one sweep straight into the
+     * shared data buffer, optionally split across threads by row ranges.
+     * Empty rows stay empty.
+     *
+     * @param data Concatenated row bytes
+     * @param offsets Row boundaries, rows + 1 entries
+     * @param chars Character set to use (default: standard Base64)
+     * @param options Threading (default: single-threaded)
+     * @return encode_column_result Encoded column or error
+     */
+    [[nodiscard]] inline encode_column_result<int32_t> base64_encode_column(
+        const std::span<const std::byte> data,
+        const std::span<const int32_t> offsets,
+        const std::string_view chars = base64_chars,
+        const parallel_options& options = {1})
+    {
+        return detail::encode_column(data, offsets, chars, options);
     }
 
     /**
-     * @brief Encodes a file into Base64 and writes to an output file using streaming.
+     * @brief Encodes every row of an Arrow-style large binary column (64-bit offsets).
+     */
+    [[nodiscard]] inline encode_column_result<int64_t> base64_encode_column(
+        const std::span<const std::byte> data,
+        const std::span<const int64_t> offsets,
+        const std::string_view chars = base64_chars,
+        const parallel_options& options = {1})
+    {
+        return detail::encode_column(data, offsets, chars, options);
+    }
+
+    /**
+     * @brief Decodes every row of an Arrow-style string column (32-bit offsets).
      *
-     * @param input_path Path to the input file
-     * @param output_path Path where to write the encoded result
+     * Each row must be a complete Base64 string; empty rows stay empty.
+     *
+     * @param data Concatenated encoded rows
+     * @param offsets Row boundaries, rows + 1 entries
      * @param chars Character set to use (default: standard Base64)
-     * @param chunk_size Size of chunks to read (default: 48KB)
-     * @param max_size Maximum file size to process (default: 100MB)
-     * @return std::error_code Error code (empty if successful)
+     * @param options Threading (default: single-threaded)
+     * @return decode_column_result Decoded column or error
      */
-    [[nodiscard]] inline std::error_code base64_encode_file_to_file(
-        const std::filesystem::path& input_path,
-        const std::filesystem::path& output_path,
+    [[nodiscard]] inline decode_column_result<int32_t> base64_decode_column(
+        const std::string_view data,
+        const std::span<const int32_t> offsets,
         const std::string_view chars = base64_chars,
-        const size_t chunk_size = detail::default_chunk_size,
-        const std::uintmax_t max_size = 100 * 1024 * 1024)
+        const parallel_options& options = {1})
     {
-        try
+        return detail::decode_column(data, offsets, chars, options);
+    }
+
+    /**
+     * @brief Decodes every row of an Arrow-style large string column (64-bit offsets).
+     */
+    [[nodiscard]] inline decode_column_result<int64_t> base64_decode_column(
+        const std::string_view data,
+        const std::span<const int64_t> offsets,
+        const std::string_view chars = base64_chars,
+        const parallel_options& options = {1})
+    {
+        return detail::decode_column(data, offsets, chars, options);
+    }
+
+#if defined(__cpp_lib_execution)
+    namespace detail
+    {
+        // Input bytes per parallel-algorithm element (64KB of encoded output)
+        constexpr size_t policy_block_size = 48 * 1024;
+
+        [[nodiscard]] inline std::vector<size_t> block_indices(
+            const size_t total, const size_t block)
         {
-            std::ofstream output(output_path);
-            if (!output.is_open())
-                return make_error_code(error::io_error);
+            std::vector<size_t> indices((total + block - 1) / block);
+            std::iota(indices.begin(), indices.end(), size_t{0});
+            return indices;
+        }
+    } // namespace detail
 
-            // Validate input parameters
-            if (!detail::validate_charset(chars))
-                return make_error_code(
-                    chars.size() != 64
-                        ? error::invalid_character_set_length
-                        : error::invalid_character_set_padding_char_used);
+    /**
+     * @brief Encodes bytes into Base64 using a standard execution policy.
+     *
+     * The input is cut into 48KB blocks (3-byte aligned) that are encoded
+     * with std::for_each under the given policy, each straight into its
+     * region of the pre-sized result.
+     *
+     * @param policy Execution policy (e.g. std::execution::par_unseq)
+     * @param input Bytes to encode
+     * @param chars Character set to use (default: standard Base64)
+     * @return encode_result Encoded string or error
+     */
+    template <typename ExecutionPolicy>
+        requires std::is_execution_policy_v<std::remove_cvref_t<
+            ExecutionPolicy>>
+    [[nodiscard]] encode_result base64_encode(
+        ExecutionPolicy&& policy,
+        const std::span<const std::byte> input,
+        const std::string_view chars = base64_chars)
+    {
+        if (input.empty())
+            return detail::make_unexpected<std::string>(error::empty_data);
 
-            // Validate file
-            std::error_code ec;
-            if (!std::filesystem::exists(input_path))
-                return make_error_code(error::file_not_found);
+        if (!detail::validate_charset(chars))
+            return detail::make_unexpected<std::string>(
+                detail::charset_error(chars));
 
-            const auto file_size = std::filesystem::file_size(input_path, ec);
-            if (ec)
-                return make_error_code(error::io_error);
+        constexpr size_t block = detail::policy_block_size;
+        const auto indices = detail::block_indices(input.size(), block);
+        std::string result(detail::encoded_size(input.size()), '\0');
 
-            if (file_size == 0)
-                return make_error_code(error::empty_data);
+        std::for_each(std::forward<ExecutionPolicy>(policy),
+                      indices.begin(), indices.end(),
+                      [&](const size_t index)
+                      {
+                          const size_t offset = index * block;
+                          detail::encode_into(
+                              input.subspan(offset, std::min(
+                                                block, input.size() - offset)),
+                              result.data() + offset / 3 * 4, chars);
+                      });
 
-            if (file_size > max_size)
-                return make_error_code(error::file_too_large);
+        return result;
+    }
 
-            std::ifstream input(input_path, std::ios::binary);
-            if (!input.is_open())
-                return make_error_code(error::file_not_readable);
+    /**
+     * @brief Decodes a Base64-encoded string using a standard execution policy.
+     *
+     * The input is cut into 64KB blocks (4-character aligned) that are
+     * decoded with std::transform_reduce under the given policy, each
+     * straight into its region of the pre-sized result.
+     *
+     * @param policy Execution policy (e.g. std::execution::par_unseq)
+     * @param input Base64-encoded string
+     * @param chars Character set to use (default: standard Base64)
+     * @return decode_result Decoded bytes or error
+     */
+    template <typename ExecutionPolicy>
+        requires std::is_execution_policy_v<std::remove_cvref_t<
+            ExecutionPolicy>>
+    [[nodiscard]] decode_result base64_decode(
+        ExecutionPolicy&& policy,
+        const std::string_view input,
+        const std::string_view chars = base64_chars)
+    {
+        if (input.empty())
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::empty_data);
 
-            // Setup streaming encoder
-            detail::stream_encoder encoder(chunk_size, chars, chunk_size);
+        if (!detail::validate_charset(chars))
+            return detail::make_unexpected<std::vector<std::byte>>(
+                detail::charset_error(chars));
 
-            // Process the file in chunks and write directly to the output
-            while (input && !input.eof())
+        if (input.size() % 4 != 0)
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::invalid_length);
+
+        constexpr size_t block = detail::policy_block_size / 3 * 4;
+        const auto table = detail::make_decode_table(chars);
+        const auto indices = detail::block_indices(input.size(), block);
+        std::vector<std::byte> result(detail::decoded_size(input));
+
+        const bool valid = std::transform_reduce(
+            std::forward<ExecutionPolicy>(policy),
+            indices.begin(), indices.end(), true, std::logical_and<>{},
+            [&](const size_t index)
             {
-                auto buffer = encoder.get_buffer();
-                input.read(reinterpret_cast<char*>(buffer.data()),
-                           static_cast<std::streamsize>(buffer.size()));
+                const size_t offset = index * block;
+                const auto slice = input.substr(offset, block);
+                return detail::decode_into(slice,
+                                           result.data() + offset / 4 * 3,
+                                           table,
+                                           offset + slice.size() ==
+                                           input.size()).has_value();
+            });
 
-                const auto bytes_read = input.gcount();
-                if (bytes_read > 0)
+        if (!valid)
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::invalid_character);
+
+        return result;
+    }
+#endif // __cpp_lib_execution
+
+    /**
+     * @brief Configuration of a thread_pool.
+     *
+     * @var threads      Number of worker threads (0: std::thread::hardware_concurrency())
+     * @var cpu_affinity CPUs to pin workers to, worker i using cpu_affinity[i % size()];
+     *                   empty leaves scheduling to the OS (pinning is honoured on Linux)
+     */
+    struct thread_pool_options
+    {
+        unsigned threads = 0;
+        std::vector<unsigned> cpu_affinity;
+    };
+
+    /**
+     * @brief Work-stealing thread pool used by the batch APIs.
+     *
+     * Every worker owns a task deque: it pops its own work LIFO and, once
+     * that runs dry, steals FIFO from the other workers. Tasks submitted
+     * from a worker land in that worker's deque; external submissions are
+     * distributed round-robin. Destruction drains all queued tasks and joins
+     * the workers. Tasks must not throw; a task that waits for other tasks
+     * of the same pool must do so through wait().
+     */
+    class thread_pool
+    {
+    public:
+        using task = std::move_only_function<void()>;
+
+        explicit thread_pool(thread_pool_options options = {})
+        {
+            unsigned count = options.threads != 0
+                                 ? options.threads
+                                 : std::thread::hardware_concurrency();
+            count = std::max(count, 1u);
+
+            queues_.reserve(count);
+            for (unsigned i = 0; i < count; ++i)
+                queues_.push_back(std::make_unique<worker_queue>());
+
+            threads_.reserve(count);
+            try
+            {
+                for (unsigned i = 0; i < count; ++i)
                 {
-                    encoder.process_chunk(std::span(buffer.data(), bytes_read));
+                    threads_.emplace_back([this, i] { run(i); });
+                    if (!options.cpu_affinity.empty())
+                        pin(threads_.back(), options.cpu_affinity[
+                                i % options.cpu_affinity.size()]);
                 }
+            }
+            catch (...)
+            {
+                // Joinable threads must not be destroyed
+                shutdown();
+                throw;
+            }
+        }
 
-                // Write an encoded chunk to an output file
-                output << std::move(encoder).finalize();
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
 
-                if (!output)
-                    return make_error_code(error::io_error);
+        ~thread_pool()
+        {
+            shutdown();
+        }
+
+        /**
+         * @brief Queues a task for execution.
+         *
+         * @return false if the pool is shutting down and the task was dropped
+         */
+        bool submit(task work)
+        {
+            {
+                std::scoped_lock lock(wake_mutex_);
+                if (stopping_)
+                    return false;
+                ++pending_;
             }
 
-            // Check for read errors
-            if (input.bad())
-                return make_error_code(error::io_error);
+            const size_t target = current_pool_ == this
+                                      ? current_worker_
+                                      : next_queue_.fetch_add(
+                                          1, std::memory_order_relaxed) %
+                                      queues_.size();
+            {
+                std::scoped_lock lock(queues_[target]->mutex);
+                queues_[target]->tasks.push_back(std::move(work));
+            }
 
-            return {};
+            wake_.notify_one();
+            return true;
         }
-        catch (const std::exception&)
+
+        /**
+         * @brief Blocks until done is released.
+         *
+         * Called from one of this pool's workers, it keeps running queued
+         * tasks meanwhile, so a task can wait for work it submitted even
+         * when every worker is busy.
+         */
+        void wait(std::latch& done)
         {
-            return make_error_code(error::io_error);
+            if (current_pool_ != this)
+            {
+                done.wait();
+                return;
+            }
+
+            while (!done.try_wait())
+            {
+                if (task work; try_pop(current_worker_, work))
+                {
+                    {
+                        std::scoped_lock lock(wake_mutex_);
+                        --pending_;
+                    }
+                    work();
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
         }
-    }
+
+        // Runs every queued task, then stops and joins the workers
+        void shutdown()
+        {
+            {
+                std::scoped_lock lock(wake_mutex_);
+                if (stopping_)
+                    return;
+                stopping_ = true;
+            }
+            wake_.notify_all();
+
+            for (auto& thread : threads_)
+                if (thread.joinable())
+                    thread.join();
+        }
+
+        [[nodiscard]] unsigned size() const noexcept
+        {
+            return static_cast<unsigned>(queues_.size());
+        }
+
+    private:
+        struct worker_queue
+        {
+            std::mutex mutex;
+            std::deque<task> tasks;
+        };
+
+        std::vector<std::unique_ptr<worker_queue>> queues_;
+        std::vector<std::thread> threads_;
+        std::atomic<size_t> next_queue_{0};
+
+        std::mutex wake_mutex_;
+        std::condition_variable wake_;
+        size_t pending_ = 0;
+        bool stopping_ = false;
+
+        static inline thread_local const thread_pool* current_pool_ = nullptr;
+        static inline thread_local size_t current_worker_ = 0;
+
+        static void pin([[maybe_unused]] std::thread& thread,
+                        [[maybe_unused]] const unsigned cpu) noexcept
+        {
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+        }
+
+        bool try_pop(const size_t index, task& out)
+        {
+            {
+                auto& own = *queues_[index];
+                std::scoped_lock lock(own.mutex);
+                if (!own.tasks.empty())
+                {
+                    out = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+
+            for (size_t i = 1; i < queues_.size(); ++i)
+            {
+                auto& victim = *queues_[(index + i) % queues_.size()];
+                std::scoped_lock lock(victim.mutex);
+                if (!victim.tasks.empty())
+                {
+                    out = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void run(const size_t index)
+        {
+            current_pool_ = this;
+            current_worker_ = index;
+
+            for (;;)
+            {
+                if (task work; try_pop(index, work))
+                {
+                    {
+                        std::scoped_lock lock(wake_mutex_);
+                        --pending_;
+                    }
+                    work();
+                    continue;
+                }
+
+                std::unique_lock lock(wake_mutex_);
+                wake_.wait(lock, [this] { return stopping_ || pending_ != 0; });
+                if (stopping_ && pending_ == 0)
+                    return;
+            }
+        }
+    };
+
+    namespace detail
+    {
+        // Input bytes grouped into a single batch task (fits comfortably in L2)
+        constexpr size_t default_batch_task_bytes = 64 * 1024;
+
+        /**
+         * @brief Splits [0, units) into contiguous ranges and runs fn(first, last) on each.
+         *
+         * The last range runs on the calling thread; the others are
+         * submitted to the pool and waited for through thread_pool::wait().
+         * fn must not throw.
+         */
+        template <typename Fn>
+        void parallel_for_ranges(thread_pool& pool,
+                                 const size_t units,
+                                 const unsigned workers,
+                                 Fn&& fn)
+        {
+            std::latch done(static_cast<std::ptrdiff_t>(workers - 1));
+
+            const size_t per_worker = units / workers;
+            const size_t extra = units % workers;
+            size_t first = 0;
+
+            for (unsigned w = 0; w < workers; ++w)
+            {
+                const size_t last = first + per_worker + (w < extra ? 1 : 0);
+                if (w + 1 == workers)
+                {
+                    fn(first, last);
+                }
+                else
+                {
+                    auto work = [&fn, &done, first, last]
+                    {
+                        fn(first, last);
+                        done.count_down();
+                    };
+                    if (!pool.submit(work))
+                        work();
+                }
+                first = last;
+            }
+
+            pool.wait(done);
+        }
+    } // namespace detail
+
+    /**
+     * @brief Process-wide pool used by the batch APIs when none is given.
+     */
+    [[nodiscard]] inline thread_pool& default_thread_pool()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Encodes many small messages on a thread pool.
+     *
+     * Consecutive messages are grouped into tasks of roughly task_bytes
+     * input so that per-task overhead is amortized while each group stays
+     * cache resident. Blocks until every message has been encoded.
+     *
+     * @param pool Pool that runs the tasks
+     * @param inputs Messages to encode
+     * @param chars Character set to use (default: standard Base64)
+     * @param task_bytes Input bytes grouped into one task (default: 64KB)
+     * @return One encode_result per input, in input order
+     */
+    [[nodiscard]] inline std::vector<encode_result> base64_encode_batch(
+        thread_pool& pool,
+        const std::span<const std::span<const std::byte>> inputs,
+        const std::string_view chars = base64_chars,
+        const size_t task_bytes = detail::default_batch_task_bytes)
+    {
+        std::vector<encode_result> results(inputs.size());
+
+        std::vector<std::pair<size_t, size_t>> groups;
+        for (size_t first = 0; first < inputs.size();)
+        {
+            size_t last = first;
+            size_t bytes = 0;
+            while (last < inputs.size() && (last == first || bytes <
+                task_bytes))
+                bytes += inputs[last++].size();
+            groups.emplace_back(first, last);
+            first = last;
+        }
+
+        std::latch done(static_cast<std::ptrdiff_t>(groups.size()));
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+
+        for (const auto& [first, last] : groups)
+        {
+            auto work = [&, first, last]
+            {
+                try
+                {
+                    for (size_t i = first; i < last; ++i)
+                        results[i] = base64_encode(inputs[i], chars);
+                }
+                catch (...)
+                {
+                    std::scoped_lock lock(failure_mutex);
+                    if (!failure)
+                        failure = std::current_exception();
+                }
+                done.count_down();
+            };
+
+            if (!pool.submit(work))
+                work();
+        }
+
+        pool.wait(done);
+        if (failure)
+            std::rethrow_exception(failure);
+
+        return results;
+    }
+
+    /**
+     * @brief Encodes many small messages on the default_thread_pool().
+     */
+    [[nodiscard]] inline std::vector<encode_result> base64_encode_batch(
+        const std::span<const std::span<const std::byte>> inputs,
+        const std::string_view chars = base64_chars,
+        const size_t task_bytes = detail::default_batch_task_bytes)
+    {
+        return base64_encode_batch(default_thread_pool(), inputs, chars,
+                                   task_bytes);
+    }
+
+    /**
+     * @brief Default max_size of the file functions: inputs of any size are accepted.
+     *
+     * File-to-file and descriptor encoding keep memory bounded by their
+     * chunk sizes. Functions returning the whole result in memory fail with
+     * file_too_large when the result would not fit in the address space.
+     */
+    inline constexpr std::uintmax_t no_size_limit =
+        std::numeric_limits<std::uintmax_t>::max();
+
+    /**
+     * @brief chunk_size value selecting a size from the cache topology and
+     * the file's preferred I/O block size.
+     */
+    inline constexpr size_t auto_chunk_size = 0;
+
+    /**
+     * @brief Inputs and outcome of automatic chunk sizing, for logging.
+     *
+     * @var l1_cache_size L1 data cache size in bytes
+     * @var l2_cache_size L2 cache size in bytes
+     * @var io_block_size Preferred I/O size of the file (st_blksize)
+     * @var chunk_size Chosen read and encode block size in bytes
+     */
+    struct chunk_sizing
+    {
+        size_t l1_cache_size;
+        size_t l2_cache_size;
+        size_t io_block_size;
+        size_t chunk_size;
+    };
+
+    namespace detail
+    {
+        struct cache_topology
+        {
+            size_t l1_data = 32 * 1024;
+            size_t l2 = 256 * 1024;
+        };
+
+        /**
+         * @brief Reads the L1 data and L2 cache sizes of the first CPU.
+         *
+         * Uses sysfs on Linux, then sysconf (backed by cpuid on glibc),
+         * keeping conservative defaults for anything not found.
+         */
+        [[nodiscard]] inline cache_topology detect_cache_topology() noexcept
+        {
+            cache_topology caches;
+#if defined(__linux__)
+            try
+            {
+                bool found_l1 = false;
+                bool found_l2 = false;
+                for (int index = 0; index < 8; ++index)
+                {
+                    const std::string dir =
+                        "/sys/devices/system/cpu/cpu0/cache/index" +
+                        std::to_string(index) + "/";
+                    int level = 0;
+                    std::string type;
+                    std::string size;
+                    if (!(std::ifstream(dir + "level") >> level) ||
+                        !(std::ifstream(dir + "type") >> type) ||
+                        !(std::ifstream(dir + "size") >> size))
+                        break;
+
+                    // Sizes read like "48K" or "2048K"
+                    size_t bytes = std::stoull(size);
+                    if (size.back() == 'K')
+                        bytes *= 1024;
+                    else if (size.back() == 'M')
+                        bytes *= 1024 * 1024;
+
+                    if (level == 1 && type != "Instruction")
+                    {
+                        caches.l1_data = bytes;
+                        found_l1 = true;
+                    }
+                    else if (level == 2)
+                    {
+                        caches.l2 = bytes;
+                        found_l2 = true;
+                    }
+                }
+
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+                if (const long l1 = ::sysconf(_SC_LEVEL1_DCACHE_SIZE);
+                    !found_l1 && l1 > 0)
+                    caches.l1_data = static_cast<size_t>(l1);
+                if (const long l2 = ::sysconf(_SC_LEVEL2_CACHE_SIZE);
+                    !found_l2 && l2 > 0)
+                    caches.l2 = static_cast<size_t>(l2);
+#endif
+            }
+            catch (const std::exception&)
+            {
+            }
+#endif
+            return caches;
+        }
+
+        [[nodiscard]] inline const cache_topology& current_cache_topology()
+        {
+            static const cache_topology caches = detect_cache_topology();
+            return caches;
+        }
+
+        /**
+         * @brief Picks the largest chunk whose input and encoding fit in half of L2.
+         *
+         * The chunk is a multiple of three I/O blocks, so reads line up with
+         * the device and encode to whole quads, and never smaller than L1.
+         */
+        [[nodiscard]] inline chunk_sizing make_chunk_sizing(
+            const cache_topology& caches, size_t io_block) noexcept
+        {
+            if (io_block == 0)
+                io_block = 4096;
+
+            // Input chunk plus 4/3 of it as output
+            const size_t budget = caches.l2 / 2 / 7 * 3;
+            const size_t unit = 3 * io_block;
+            const size_t floor = (caches.l1_data + unit - 1) / unit * unit;
+
+            return {
+                caches.l1_data, caches.l2, io_block,
+                std::max(budget / unit * unit, std::max(floor, unit))
+            };
+        }
+    } // namespace detail
+
+    /**
+     * @brief Computes the automatic chunk size for reading a file.
+     *
+     * @param path File whose preferred I/O block size is used; a missing
+     *             file uses the block size of its directory
+     * @return chunk_sizing The detected sizes and the chosen chunk size
+     */
+    [[nodiscard]] inline chunk_sizing auto_chunk_sizing(
+        [[maybe_unused]] const std::filesystem::path& path)
+    {
+        size_t io_block = 0;
+#if BASE64_POSIX_IO
+        struct stat info{};
+        if (::stat(path.c_str(), &info) == 0 ||
+            ::stat(path.parent_path().empty()
+                       ? "."
+                       : path.parent_path().c_str(), &info) == 0)
+            io_block = static_cast<size_t>(info.st_blksize);
+#endif
+        return detail::make_chunk_sizing(detail::current_cache_topology(),
+                                         io_block);
+    }
+
+    namespace detail
+    {
+        [[nodiscard]] inline size_t resolve_chunk_size(
+            const size_t chunk_size, const std::filesystem::path& path)
+        {
+            return chunk_size != auto_chunk_size
+                       ? chunk_size
+                       : auto_chunk_sizing(path).chunk_size;
+        }
+    } // namespace detail
+
+    namespace detail
+    {
+        // Optimal chunk size (multiple of 3 for base64 encoding efficiency)
+        constexpr size_t default_chunk_size = 48 * 1024; // 48KB chunks
+
+        using input_size_result =
+        std::expected<std::optional<std::uintmax_t>, std::error_code>;
+
+        /**
+         * @brief Validates an input file and returns its size if it is reliable.
+         *
+         * FIFOs, character devices such as /dev/stdin and procfs files have
+         * no usable size (procfs reports 0 for files with content), so
+         * std::nullopt is returned for them and for empty regular files.
+         * Such inputs must be read until end of file, checking max_size and
+         * emptiness on the way.
+         */
+        [[nodiscard]] inline input_size_result input_size(
+            const std::filesystem::path& path,
+            const std::uintmax_t max_size)
+        {
+            std::error_code ec;
+            const auto status = std::filesystem::status(path, ec);
+            if (!std::filesystem::exists(status))
+                return std::unexpected(make_error_code(error::file_not_found));
+
+            if (!std::filesystem::is_regular_file(status))
+                return std::nullopt;
+
+            const auto file_size = std::filesystem::file_size(path, ec);
+            if (ec)
+                return std::unexpected(make_error_code(error::io_error));
+
+            if (file_size == 0)
+                return std::nullopt;
+
+            if (file_size > max_size)
+                return std::unexpected(make_error_code(error::file_too_large));
+
+            return file_size;
+        }
+
+        // Running total of a size-less input, checked against max_size
+        [[nodiscard]] inline bool count_input(std::uintmax_t& total,
+                                              const std::streamsize bytes_read,
+                                              const std::uintmax_t max_size)
+            noexcept
+        {
+            total += static_cast<std::uintmax_t>(bytes_read);
+            return total <= max_size;
+        }
+
+        // Files from this size on are encoded from a memory mapping
+        constexpr std::uintmax_t mmap_threshold = 64 * 1024;
+
+        // Larger mappings are faulted in on access instead of up front
+        constexpr size_t populate_limit = 64 * 1024 * 1024;
+
+        /**
+         * @brief Whether a file of size bytes can be mapped, and both it and its
+         * encoding addressed with the platform's file offsets.
+         *
+         * Paths relying on mapping or positional I/O fall back to sequential
+         * streaming otherwise, e.g. on 32-bit builds without 64-bit off_t.
+         */
+        [[nodiscard]] constexpr bool fits_positional_io(
+            const std::uintmax_t size) noexcept
+        {
+#if BASE64_POSIX_IO
+            using offset_type = off_t;
+#else
+            using offset_type = std::int64_t;
+#endif
+            constexpr auto max_offset = static_cast<std::uintmax_t>(
+                std::numeric_limits<offset_type>::max());
+            return size <= std::numeric_limits<size_t>::max() &&
+                size / 3 < max_offset / 4 - 1;
+        }
+
+#if BASE64_POSIX_IO
+        class unique_fd
+        {
+            int fd_ = -1;
+
+        public:
+            unique_fd() = default;
+
+            explicit unique_fd(const int fd) noexcept
+                : fd_(fd)
+            {
+            }
+
+            unique_fd(unique_fd&& other) noexcept
+                : fd_(std::exchange(other.fd_, -1))
+            {
+            }
+
+            unique_fd& operator=(unique_fd&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    reset();
+                    fd_ = std::exchange(other.fd_, -1);
+                }
+                return *this;
+            }
+
+            ~unique_fd()
+            {
+                reset();
+            }
+
+            void reset() noexcept
+            {
+                if (fd_ >= 0)
+                    ::close(fd_);
+                fd_ = -1;
+            }
+
+            [[nodiscard]] int get() const noexcept
+            {
+                return fd_;
+            }
+
+            explicit operator bool() const noexcept
+            {
+                return fd_ >= 0;
+            }
+        };
+
+        // pwrite() until everything is written or a real error occurs
+        [[nodiscard]] inline bool write_all_at(const int fd,
+                                               const void* data,
+                                               size_t size,
+                                               off_t offset) noexcept
+        {
+            const auto* bytes = static_cast<const char*>(data);
+            while (size != 0)
+            {
+                const ssize_t written = ::pwrite(fd, bytes, size, offset);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+
+                bytes += written;
+                size -= static_cast<size_t>(written);
+                offset += written;
+            }
+            return true;
+        }
+
+        // Sizes the file to exactly size bytes, reserving its blocks up front
+        [[nodiscard]] inline bool preallocate(const int fd,
+                                              const std::uintmax_t size) noexcept
+        {
+            if (::ftruncate(fd, 0) != 0)
+                return false;
+            if (size == 0)
+                return true;
+#if defined(__linux__)
+            if (::fallocate(fd, 0, 0, static_cast<off_t>(size)) == 0)
+                return true;
+#endif
+            return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+        }
+#endif
+
+        /**
+         * @brief Read-only mapping of a whole regular file.
+         *
+         * The mapping is populated eagerly and advised for sequential access.
+         * Only available on POSIX systems; open() returns std::nullopt
+         * wherever a file cannot be mapped so callers can fall back to streams.
+         */
+        class mapped_file
+        {
+            const std::byte* data_ = nullptr;
+            size_t size_ = 0;
+
+            mapped_file(const std::byte* data, const size_t size) noexcept
+                : data_(data)
+                  , size_(size)
+            {
+            }
+
+        public:
+            mapped_file(mapped_file&& other) noexcept
+                : data_(std::exchange(other.data_, nullptr))
+                  , size_(std::exchange(other.size_, 0))
+            {
+            }
+
+            mapped_file& operator=(mapped_file&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    unmap();
+                    data_ = std::exchange(other.data_, nullptr);
+                    size_ = std::exchange(other.size_, 0);
+                }
+                return *this;
+            }
+
+            ~mapped_file()
+            {
+                unmap();
+            }
+
+            /**
+             * @brief Maps path, which must still be a regular file of expected_size bytes.
+             */
+            [[nodiscard]] static std::optional<mapped_file> open(
+                [[maybe_unused]] const std::filesystem::path& path,
+                [[maybe_unused]] const std::uintmax_t expected_size)
+            {
+#if BASE64_POSIX_IO
+                const unique_fd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+                if (!fd)
+                    return std::nullopt;
+
+                struct stat info{};
+                if (::fstat(fd.get(), &info) != 0 || !S_ISREG(info.st_mode) ||
+                    info.st_size <= 0 ||
+                    static_cast<std::uintmax_t>(info.st_size) != expected_size ||
+                    !fits_positional_io(expected_size))
+                    return std::nullopt;
+
+                return map(fd.get(), static_cast<size_t>(info.st_size));
+#else
+                return std::nullopt;
+#endif
+            }
+
+#if BASE64_POSIX_IO
+            /**
+             * @brief Maps the first size bytes of an open regular file.
+             */
+            [[nodiscard]] static std::optional<mapped_file> map(
+                const int fd, const size_t size)
+            {
+                int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+                // Prefaulting a huge file would read all of it up front
+                if (size <= populate_limit)
+                    flags |= MAP_POPULATE;
+#endif
+                void* data = ::mmap(nullptr, size, PROT_READ, flags, fd, 0);
+                if (data == MAP_FAILED)
+                    return std::nullopt;
+
+                ::madvise(data, size, MADV_SEQUENTIAL);
+                return mapped_file(static_cast<const std::byte*>(data), size);
+            }
+#endif
+
+            [[nodiscard]] std::span<const std::byte> bytes() const noexcept
+            {
+                return {data_, size_};
+            }
+
+        private:
+            void unmap() noexcept
+            {
+#if BASE64_POSIX_IO
+                if (data_)
+                    ::munmap(const_cast<std::byte*>(data_), size_);
+#endif
+                data_ = nullptr;
+                size_ = 0;
+            }
+        };
+
+        template <typename Allocator = std::allocator<char>>
+        class basic_stream_encoder
+        {
+            using byte_allocator = typename std::allocator_traits<
+                Allocator>::template rebind_alloc<std::byte>;
+            using string_type = std::basic_string<
+                char, std::char_traits<char>, Allocator>;
+
+            std::vector<std::byte, byte_allocator> buffer_;
+            string_type result_;
+            const std::string_view chars_;
+            const size_t chunk_size_;
+            std::array<std::byte, 3> carry_{};
+            size_t carry_size_ = 0;
+
+            void append(const std::span<const std::byte> bytes)
+            {
+                const size_t old_size = result_.size();
+                result_.resize(old_size + encoded_size(bytes.size()));
+                encode_into(bytes, result_.data() + old_size, chars_);
+            }
+
+        public:
+            explicit basic_stream_encoder(
+                const size_t reserved_size,
+                const std::string_view chars = base64_chars,
+                const size_t chunk_size = default_chunk_size,
+                const Allocator& allocator = Allocator())
+                : buffer_(chunk_size, byte_allocator(allocator))
+                  , result_(allocator)
+                  , chars_(chars)
+                  , chunk_size_(chunk_size)
+            {
+                // Reserve estimated final size plus some padding
+                result_.reserve((reserved_size + 2) / 3 * 4);
+            }
+
+            void process_chunk(std::span<const std::byte> chunk)
+            {
+                // Complete a triple left over from the previous chunk first so
+                // that padding is only ever emitted by finalize()
+                if (carry_size_ != 0)
+                {
+                    const size_t take = std::min(3 - carry_size_, chunk.size());
+                    std::copy_n(chunk.begin(), take,
+                                carry_.begin() + carry_size_);
+                    carry_size_ += take;
+                    chunk = chunk.subspan(take);
+
+                    if (carry_size_ < 3)
+                        return;
+
+                    append(carry_);
+                    carry_size_ = 0;
+                }
+
+                const size_t full = chunk.size() - chunk.size() % 3;
+                append(chunk.first(full));
+
+                carry_size_ = chunk.size() - full;
+                std::copy_n(chunk.begin() + full, carry_size_, carry_.begin());
+            }
+
+            // Encoded output so far; a trailing partial triple stays pending
+            [[nodiscard]] std::string_view output() const noexcept
+            {
+                return result_;
+            }
+
+            void clear_output() noexcept
+            {
+                result_.clear();
+            }
+
+            [[nodiscard]] string_type&& finalize() &&
+            {
+                append(std::span(carry_).first(carry_size_));
+                carry_size_ = 0;
+                return std::move(result_);
+            }
+
+            [[nodiscard]] std::span<std::byte> get_buffer() noexcept
+            {
+                return {buffer_.data(), buffer_.size()};
+            }
+        };
+
+        using stream_encoder = basic_stream_encoder<>;
+
+        template <typename Allocator = std::allocator<std::byte>>
+        class basic_stream_decoder
+        {
+            using char_allocator_type = typename std::allocator_traits<
+                Allocator>::template rebind_alloc<char>;
+            using vector_type = std::vector<std::byte, Allocator>;
+
+            std::vector<char, char_allocator_type> buffer_;
+            vector_type result_;
+            const decode_table table_;
+            // Partial quad plus the last complete quad, which may hold padding
+            std::array<char, 8> carry_{};
+            size_t carry_size_ = 0;
+            // Input offset of the first character not decoded yet
+            std::uintmax_t decoded_ = 0;
+            std::optional<std::uintmax_t> invalid_offset_;
+
+            [[nodiscard]] bool append(const std::string_view quads,
+                                      const bool is_last)
+            {
+                const size_t old_size = result_.size();
+                result_.resize(old_size + quads.size() / 4 * 3);
+
+                const auto end = decode_into(
+                    quads, result_.data() + old_size, table_, is_last);
+                if (!end)
+                {
+                    invalid_offset_ = decoded_ + end.error();
+                    return false;
+                }
+
+                decoded_ += quads.size() / 4 * 4;
+                result_.resize(static_cast<size_t>(*end - result_.data()));
+                return true;
+            }
+
+        public:
+            explicit basic_stream_decoder(
+                const size_t reserved_size,
+                const std::string_view chars = base64_chars,
+                const size_t chunk_size = default_chunk_size,
+                const Allocator& allocator = Allocator())
+                : buffer_(chunk_size, char_allocator_type(allocator))
+                  , result_(allocator)
+                  , table_(make_decode_table(chars))
+            {
+                result_.reserve(reserved_size / 4 * 3);
+            }
+
+            /**
+             * @brief Decodes all complete quads of chunk except the last one.
+             *
+             * The last complete quad and any partial quad are carried over
+             * until more input or finalize() shows whether they end the data.
+             *
+             * @return false on an invalid character
+             */
+            [[nodiscard]] bool process_chunk(std::string_view chunk)
+            {
+                if (carry_size_ != 0)
+                {
+                    const size_t take = std::min(carry_.size() - carry_size_,
+                                                 chunk.size());
+                    std::copy_n(chunk.begin(), take,
+                                carry_.begin() + carry_size_);
+                    carry_size_ += take;
+                    chunk.remove_prefix(take);
+
+                    if (chunk.empty())
+                    {
+                        // Only the second quad of a full carry can be the last
+                        if (carry_size_ == carry_.size())
+                        {
+                            if (!append({carry_.data(), 4}, false))
+                                return false;
+                            std::copy_n(carry_.begin() + 4, 4, carry_.begin());
+                            carry_size_ = 4;
+                        }
+                        return true;
+                    }
+
+                    if (!append({carry_.data(), carry_size_}, false))
+                        return false;
+                    carry_size_ = 0;
+                }
+
+                const size_t decodable = chunk.size() < 4
+                                             ? 0
+                                             : chunk.size() - chunk.size() % 4
+                                             - 4;
+                if (!append(chunk.substr(0, decodable), false))
+                    return false;
+
+                carry_size_ = chunk.size() - decodable;
+                std::copy_n(chunk.begin() + decodable, carry_size_,
+                            carry_.begin());
+                return true;
+            }
+
+            // Decoded output so far; the carried quads stay pending
+            [[nodiscard]] std::span<const std::byte> output() const noexcept
+            {
+                return result_;
+            }
+
+            void clear_output() noexcept
+            {
+                result_.clear();
+            }
+
+            // Input offset of the first invalid character, once one was found
+            [[nodiscard]] std::optional<std::uintmax_t> invalid_offset() const
+                noexcept
+            {
+                return invalid_offset_;
+            }
+
+            /**
+             * @brief Decodes the final quad and returns the remaining output.
+             */
+            [[nodiscard]] std::expected<vector_type, error> finalize() &&
+            {
+                if (carry_size_ != 4)
+                    return std::unexpected(carry_size_ == 0
+                                               ? error::empty_data
+                                               : error::invalid_length);
+
+                if (!append({carry_.data(), carry_size_}, true))
+                    return std::unexpected(error::invalid_character);
+
+                carry_size_ = 0;
+                return std::move(result_);
+            }
+
+            [[nodiscard]] std::span<char> get_buffer() noexcept
+            {
+                return {buffer_.data(), buffer_.size()};
+            }
+        };
+
+        using stream_decoder = basic_stream_decoder<>;
+    } // namespace detail
+
+    /**
+     * @brief Encodes a file into a Base64-encoded string using streaming.
+     *
+     * This implementation:
+     * - Encodes files of 64KB and more straight from a read-only memory
+     *   mapping where supported, falling back to streaming otherwise
+     * - Reads FIFOs, devices such as /dev/stdin and procfs files, whose
+     *   size is unknown, until end of file with geometric output growth
+     * - Uses chunked reading for memory efficiency
+     * - Pre-allocates buffers for optimal performance
+     * - Avoids unnecessary memory reallocations
+     * - Processes data in a streaming fashion
+     *
+     * Passing huge_page_allocator<char> backs large results and chunk
+     * buffers with huge pages.
+     *
+     * @param path Path to the file to encode
+     * @param allocator Allocator for the encoded string and chunk buffer
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return Encoded string or error
+     */
+    template <detail::char_allocator Allocator>
+    [[nodiscard]] basic_encode_result<Allocator> base64_encode_file(
+        const std::filesystem::path& path,
+        const Allocator& allocator,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        // Validate input parameters
+        if (!detail::validate_charset(chars))
+            return detail::make_unexpected<std::string>(
+                chars.size() != 64
+                    ? error::invalid_character_set_length
+                    : error::invalid_character_set_padding_char_used);
+
+        // Validate file
+        const auto file_size = detail::input_size(path, max_size);
+        if (!file_size)
+            return std::unexpected(file_size.error());
+
+        if (*file_size && **file_size > std::numeric_limits<size_t>::max() / 4 * 3)
+            return detail::make_unexpected<std::string>(error::file_too_large);
+
+        // Encode straight from a read-only mapping when the file allows it,
+        // avoiding the copy into the chunk buffer
+        if (*file_size && **file_size >= detail::mmap_threshold)
+        {
+            if (const auto mapping = detail::mapped_file::open(path,
+                **file_size))
+            {
+                try
+                {
+                    std::basic_string<char, std::char_traits<char>, Allocator>
+                        result(detail::encoded_size(mapping->bytes().size()),
+                               '\0', allocator);
+                    detail::encode_into(mapping->bytes(), result.data(), chars);
+                    return result;
+                }
+                catch (const std::exception&)
+                {
+                    return detail::make_unexpected<std::string>(
+                        error::io_error);
+                }
+            }
+        }
+
+        // Open a file with exception handling
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return detail::make_unexpected<std::string>(
+                error::file_not_readable);
+
+        try
+        {
+            // Setup streaming encoder with pre-allocated buffers; without a
+            // reliable size the result grows geometrically instead
+            const size_t read_size = detail::resolve_chunk_size(chunk_size,
+                path);
+            detail::basic_stream_encoder<Allocator> encoder(
+                static_cast<size_t>(file_size->value_or(read_size)), chars,
+                read_size, allocator);
+            std::uintmax_t total = 0;
+
+            // Process file in chunks
+            while (file && !file.eof())
+            {
+                auto buffer = encoder.get_buffer();
+                file.read(reinterpret_cast<char*>(buffer.data()),
+                          static_cast<std::streamsize>(buffer.size()));
+
+                if (const auto bytes_read = file.gcount(); bytes_read > 0)
+                {
+                    if (!detail::count_input(total, bytes_read, max_size))
+                        return detail::make_unexpected<std::string>(
+                            error::file_too_large);
+                    encoder.process_chunk(std::span(buffer.data(), bytes_read));
+                }
+            }
+
+            // Check for read errors
+            if (file.bad())
+                return detail::make_unexpected<std::string>(error::io_error);
+
+            if (total == 0)
+                return detail::make_unexpected<std::string>(error::empty_data);
+
+            // Finalize and return the result
+            return std::move(encoder).finalize();
+        }
+        catch (const std::exception&)
+        {
+            return detail::make_unexpected<std::string>(error::io_error);
+        }
+    }
+
+    /**
+     * @brief Encodes a file into a Base64-encoded string using streaming.
+     *
+     * @param path Path to the file to encode
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return encode_result Encoded string or error
+     */
+    [[nodiscard]] inline encode_result base64_encode_file(
+        const std::filesystem::path& path,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        return base64_encode_file(path, std::allocator<char>{}, chars,
+                                  chunk_size, max_size);
+    }
+
+    /**
+     * @brief Encodes a file into Base64 and writes to an output file using streaming.
+     *
+     * @param input_path Path to the input file
+     * @param output_path Path where to write the encoded result
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_encode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        try
+        {
+            std::ofstream output(output_path);
+            if (!output.is_open())
+                return make_error_code(error::io_error);
+
+            // Validate input parameters
+            if (!detail::validate_charset(chars))
+                return make_error_code(
+                    chars.size() != 64
+                        ? error::invalid_character_set_length
+                        : error::invalid_character_set_padding_char_used);
+
+            // Validate file
+            if (const auto file_size = detail::input_size(
+                input_path, max_size); !file_size)
+                return file_size.error();
+
+            std::ifstream input(input_path, std::ios::binary);
+            if (!input.is_open())
+                return make_error_code(error::file_not_readable);
+
+            // Setup streaming encoder
+            const size_t read_size = detail::resolve_chunk_size(chunk_size,
+                input_path);
+            detail::stream_encoder encoder(read_size, chars, read_size);
+            std::uintmax_t total = 0;
+
+            // Process the file in chunks and write directly to the output
+            while (input && !input.eof())
+            {
+                auto buffer = encoder.get_buffer();
+                input.read(reinterpret_cast<char*>(buffer.data()),
+                           static_cast<std::streamsize>(buffer.size()));
+
+                const auto bytes_read = input.gcount();
+                if (bytes_read > 0)
+                {
+                    if (!detail::count_input(total, bytes_read, max_size))
+                        return make_error_code(error::file_too_large);
+                    encoder.process_chunk(std::span(buffer.data(), bytes_read));
+                }
+
+                // Write the encoded chunk to the output file
+                output << encoder.output();
+                encoder.clear_output();
+
+                if (!output)
+                    return make_error_code(error::io_error);
+            }
+
+            // Check for read errors
+            if (input.bad())
+                return make_error_code(error::io_error);
+
+            if (total == 0)
+                return make_error_code(error::empty_data);
+
+            // Flush the trailing partial triple with padding
+            output << std::move(encoder).finalize();
+            if (!output)
+                return make_error_code(error::io_error);
+
+            return {};
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+    /**
+     * @brief Decodes a Base64-encoded file into bytes using the given allocator.
+     *
+     * The file is read in chunks; partial quads are carried across chunk
+     * boundaries and padding is only accepted at the very end. Passing
+     * huge_page_allocator<std::byte> backs large results and chunk buffers
+     * with huge pages.
+     *
+     * @param path Path to the encoded file
+     * @param allocator Allocator for the decoded bytes and chunk buffer
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return Decoded bytes or error
+     */
+    template <detail::byte_allocator Allocator>
+    [[nodiscard]] basic_decode_result<Allocator> base64_decode_file(
+        const std::filesystem::path& path,
+        const Allocator& allocator,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        if (!detail::validate_charset(chars))
+            return detail::make_unexpected<std::vector<std::byte>>(
+                detail::charset_error(chars));
+
+        const auto file_size = detail::input_size(path, max_size);
+        if (!file_size)
+            return std::unexpected(file_size.error());
+
+        if (*file_size && **file_size % 4 != 0)
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::invalid_length);
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::file_not_readable);
+
+        try
+        {
+            const size_t read_size = detail::resolve_chunk_size(chunk_size,
+                path);
+            detail::basic_stream_decoder<Allocator> decoder(
+                static_cast<size_t>(file_size->value_or(read_size)), chars,
+                read_size, allocator);
+            std::uintmax_t total = 0;
+
+            while (file && !file.eof())
+            {
+                auto buffer = decoder.get_buffer();
+                file.read(buffer.data(),
+                          static_cast<std::streamsize>(buffer.size()));
+
+                const auto bytes_read = file.gcount();
+                if (!detail::count_input(total, bytes_read, max_size))
+                    return detail::make_unexpected<std::vector<std::byte>>(
+                        error::file_too_large);
+
+                if (bytes_read > 0 && !decoder.process_chunk({
+                        buffer.data(), static_cast<size_t>(bytes_read)
+                    }))
+                    return detail::make_unexpected<std::vector<std::byte>>(
+                        error::invalid_character);
+            }
+
+            if (file.bad())
+                return detail::make_unexpected<std::vector<std::byte>>(
+                    error::io_error);
+
+            auto result = std::move(decoder).finalize();
+            if (!result)
+                return detail::make_unexpected<std::vector<std::byte>>(
+                    result.error());
+
+            return std::move(*result);
+        }
+        catch (const std::exception&)
+        {
+            return detail::make_unexpected<std::vector<std::byte>>(
+                error::io_error);
+        }
+    }
+
+    /**
+     * @brief Decodes a Base64-encoded file into bytes using streaming.
+     *
+     * The file is read in chunks; partial quads are carried across chunk
+     * boundaries and padding is only accepted at the very end.
+     *
+     * @param path Path to the encoded file
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return decode_result Decoded bytes or error
+     */
+    [[nodiscard]] inline decode_result base64_decode_file(
+        const std::filesystem::path& path,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        return base64_decode_file(path, std::allocator<std::byte>{}, chars,
+                                  chunk_size, max_size);
+    }
+
+    namespace detail
+    {
+        // Streaming decode to a file; sets invalid_offset on invalid_character
+        [[nodiscard]] inline std::error_code decode_file_streaming(
+            const std::filesystem::path& input_path,
+            const std::filesystem::path& output_path,
+            const std::string_view chars,
+            const size_t chunk_size,
+            const std::uintmax_t max_size,
+            std::optional<std::uintmax_t>& invalid_offset)
+        {
+            try
+            {
+                if (!validate_charset(chars))
+                    return make_error_code(charset_error(chars));
+
+                const auto file_size = input_size(input_path, max_size);
+                if (!file_size)
+                    return file_size.error();
+
+                if (*file_size && **file_size % 4 != 0)
+                    return make_error_code(error::invalid_length);
+
+                std::ifstream input(input_path, std::ios::binary);
+                if (!input.is_open())
+                    return make_error_code(error::file_not_readable);
+
+                std::ofstream output(output_path, std::ios::binary);
+                if (!output.is_open())
+                    return make_error_code(error::io_error);
+
+                const size_t read_size = resolve_chunk_size(chunk_size,
+                    input_path);
+                stream_decoder decoder(read_size, chars, read_size);
+
+                const auto write = [&output](const std::span<const std::byte> bytes)
+                {
+                    output.write(reinterpret_cast<const char*>(bytes.data()),
+                                 static_cast<std::streamsize>(bytes.size()));
+                    return static_cast<bool>(output);
+                };
+
+                std::uintmax_t total = 0;
+                while (input && !input.eof())
+                {
+                    auto buffer = decoder.get_buffer();
+                    input.read(buffer.data(),
+                               static_cast<std::streamsize>(buffer.size()));
+
+                    const auto bytes_read = input.gcount();
+                    if (!count_input(total, bytes_read, max_size))
+                        return make_error_code(error::file_too_large);
+
+                    if (bytes_read > 0 && !decoder.process_chunk({
+                            buffer.data(), static_cast<size_t>(bytes_read)
+                        }))
+                    {
+                        invalid_offset = decoder.invalid_offset();
+                        return make_error_code(error::invalid_character);
+                    }
+
+                    if (!write(decoder.output()))
+                        return make_error_code(error::io_error);
+                    decoder.clear_output();
+                }
+
+                if (input.bad())
+                    return make_error_code(error::io_error);
+
+                const auto tail = std::move(decoder).finalize();
+                if (!tail)
+                {
+                    invalid_offset = decoder.invalid_offset();
+                    return make_error_code(tail.error());
+                }
+
+                if (!write(*tail))
+                    return make_error_code(error::io_error);
+
+                return {};
+            }
+            catch (const std::exception&)
+            {
+                return make_error_code(error::io_error);
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief Decodes a Base64-encoded file and writes the bytes to an output file using streaming.
+     *
+     * Memory use is bounded by chunk_size regardless of the file size. On
+     * an invalid character the output file holds the bytes decoded so far.
+     *
+     * @param input_path Path to the encoded file
+     * @param output_path Path where to write the decoded bytes
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_decode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        std::optional<std::uintmax_t> invalid_offset;
+        return detail::decode_file_streaming(input_path, output_path, chars,
+                                             chunk_size, max_size,
+                                             invalid_offset);
+    }
+
+    /**
+     * @brief Failure of a file decode, locating the invalid input.
+     *
+     * @var error          Reason of the failure
+     * @var invalid_offset Offset of the first invalid character in the
+     *                     encoded file; set whenever error is invalid_character
+     */
+    struct decode_file_error
+    {
+        std::error_code error;
+        std::optional<std::uintmax_t> invalid_offset;
+    };
+
+    using decode_file_result = std::expected<void, decode_file_error>;
+
+    /**
+     * @brief Progress of a file encode, as input consumed and output emitted.
+     *
+     * bytes_consumed is a multiple of 3 and bytes_emitted its encoded size,
+     * unless the end of the input (and its padding) has been reached.
+     */
+    struct encode_checkpoint
+    {
+        std::uintmax_t bytes_consumed = 0;
+        std::uintmax_t bytes_emitted = 0;
+    };
+
+    using checkpoint_result = std::expected<encode_checkpoint, std::error_code>;
+
+    namespace detail
+    {
+        // Size of an input that byte ranges can address, or why it has none
+        [[nodiscard]] inline std::expected<std::uintmax_t, std::error_code>
+        ranged_input_size(const std::filesystem::path& path)
+        {
+            const auto size = input_size(path, no_size_limit);
+            if (!size)
+                return std::unexpected(size.error());
+            if (*size)
+                return **size;
+
+            // Empty regular files, versus pipes and devices without offsets
+            std::error_code ec;
+            return std::unexpected(make_error_code(
+                std::filesystem::is_regular_file(path, ec)
+                    ? error::empty_data
+                    : error::io_error));
+        }
+    } // namespace detail
+
+    /**
+     * @brief Encodes a byte range of a file into its place in the output file.
+     *
+     * The encoding of input bytes [offset, offset + length) is written at
+     * offset / 3 * 4 of the output, which is created if needed but never
+     * truncated. Ranges thus combine into the encoding of the whole file,
+     * whether they run one after another, resume an interrupted job or are
+     * spread over several processes. The offset must be a multiple of 3,
+     * and so must the length unless the range ends at the end of the file,
+     * whose padding it then writes. Inputs without a known size, such as
+     * pipes and devices, fail with io_error.
+     *
+     * @param input_path Path to the input file
+     * @param output_path Path to the output file
+     * @param offset First input byte to encode
+     * @param length Number of bytes to encode; clamped to the end of the file
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @return checkpoint_result Position after the range, or error
+     */
+    [[nodiscard]] inline checkpoint_result base64_encode_file_range(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        const std::uintmax_t offset,
+        const std::uintmax_t length = no_size_limit,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return std::unexpected(
+                    make_error_code(detail::charset_error(chars)));
+
+            const auto file_size = detail::ranged_input_size(input_path);
+            if (!file_size)
+                return std::unexpected(file_size.error());
+
+            const std::uintmax_t size = *file_size;
+            const std::uintmax_t end = offset + std::min(length, size - std::min(
+                offset, size));
+            if (offset % 3 != 0 || offset > size ||
+                ((end - offset) % 3 != 0 && end != size))
+                return std::unexpected(make_error_code(error::invalid_length));
+
+            std::ifstream input(input_path, std::ios::binary);
+            if (!input.is_open())
+                return std::unexpected(
+                    make_error_code(error::file_not_readable));
+
+            // Create the output without truncating what other ranges wrote
+            std::ofstream(output_path, std::ios::binary | std::ios::app);
+            std::ofstream output(output_path, std::ios::binary | std::ios::in |
+                                 std::ios::out);
+            if (!output.is_open())
+                return std::unexpected(make_error_code(error::io_error));
+
+            input.seekg(static_cast<std::streamoff>(offset));
+            output.seekp(static_cast<std::streamoff>(offset / 3 * 4));
+
+            const size_t chunk = std::max<size_t>(
+                detail::resolve_chunk_size(chunk_size, input_path) / 3 * 3, 3);
+            std::vector<std::byte> buffer(chunk);
+            std::string encoded(detail::encoded_size(chunk), '\0');
+
+            encode_checkpoint checkpoint{offset, offset / 3 * 4};
+            while (checkpoint.bytes_consumed < end)
+            {
+                const auto want = static_cast<size_t>(std::min<std::uintmax_t>(
+                    chunk, end - checkpoint.bytes_consumed));
+                if (!input.read(reinterpret_cast<char*>(buffer.data()),
+                                static_cast<std::streamsize>(want)))
+                    return std::unexpected(make_error_code(error::io_error));
+
+                const char* encoded_end = detail::encode_into(
+                    {buffer.data(), want}, encoded.data(), chars);
+                const auto written = encoded_end - encoded.data();
+                if (!output.write(encoded.data(), written))
+                    return std::unexpected(make_error_code(error::io_error));
+
+                checkpoint.bytes_consumed += want;
+                checkpoint.bytes_emitted += static_cast<std::uintmax_t>(
+                    written);
+            }
+
+            if (!output.flush())
+                return std::unexpected(make_error_code(error::io_error));
+
+            return checkpoint;
+        }
+        catch (const std::exception&)
+        {
+            return std::unexpected(make_error_code(error::io_error));
+        }
+    }
+
+    /**
+     * @brief Continues an interrupted file to file encode from a checkpoint.
+     *
+     * The checkpoint must be one returned by base64_encode_file_range(),
+     * recorded only once the output up to bytes_emitted was durable (for
+     * example after an fsync). Whatever the output holds past bytes_emitted,
+     * such as unsynced or zero-filled data left by a crash, is truncated.
+     * The last chunk before the checkpoint is re-encoded and compared with
+     * the output first; a mismatch, or an output shorter than the
+     * checkpoint, fails with io_error instead of building on a corrupt
+     * prefix. A default checkpoint starts from the beginning.
+     *
+     * @param input_path Path to the input file
+     * @param output_path Path to the partially written output file
+     * @param checkpoint Position recorded before the interruption
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @return checkpoint_result Final position (the whole file), or error
+     */
+    [[nodiscard]] inline checkpoint_result base64_resume_encode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        const encode_checkpoint& checkpoint,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return std::unexpected(
+                    make_error_code(detail::charset_error(chars)));
+
+            const auto file_size = detail::ranged_input_size(input_path);
+            if (!file_size)
+                return std::unexpected(file_size.error());
+
+            // Either a whole number of triples, or the finished encoding
+            const std::uintmax_t consumed = checkpoint.bytes_consumed;
+            const bool finished = consumed == *file_size &&
+                checkpoint.bytes_emitted == (consumed + 2) / 3 * 4;
+            if (consumed > *file_size || (!finished && (consumed % 3 != 0 ||
+                checkpoint.bytes_emitted != consumed / 3 * 4)))
+                return std::unexpected(make_error_code(error::invalid_length));
+
+            std::error_code ec;
+            const std::uintmax_t output_size = checkpoint.bytes_emitted != 0
+                                                   ? std::filesystem::file_size(
+                                                       output_path, ec)
+                                                   : 0;
+            if (ec || output_size < checkpoint.bytes_emitted)
+                return std::unexpected(make_error_code(error::io_error));
+
+            if (std::filesystem::exists(output_path, ec))
+            {
+                std::filesystem::resize_file(output_path,
+                                             checkpoint.bytes_emitted, ec);
+                if (ec)
+                    return std::unexpected(make_error_code(error::io_error));
+            }
+
+            // Re-encode the last chunk before the checkpoint and compare
+            const size_t chunk = std::max<size_t>(
+                detail::resolve_chunk_size(chunk_size, input_path) / 3 * 3, 3);
+            const std::uintmax_t verify_from =
+                consumed > chunk ? (consumed - chunk + 2) / 3 * 3 : 0;
+            if (verify_from != consumed)
+            {
+                const auto size = static_cast<size_t>(consumed - verify_from);
+                std::vector<std::byte> bytes(size);
+                std::string expected(detail::encoded_size(size), '\0');
+                std::string actual(expected.size(), '\0');
+
+                std::ifstream input(input_path, std::ios::binary);
+                std::ifstream output(output_path, std::ios::binary);
+                input.seekg(static_cast<std::streamoff>(verify_from));
+                output.seekg(static_cast<std::streamoff>(verify_from / 3 * 4));
+                if (!input.read(reinterpret_cast<char*>(bytes.data()),
+                                static_cast<std::streamsize>(size)))
+                    return std::unexpected(
+                        make_error_code(error::file_not_readable));
+
+                expected.resize(static_cast<size_t>(detail::encode_into(
+                    bytes, expected.data(), chars) - expected.data()));
+                actual.resize(expected.size());
+                if (!output.read(actual.data(),
+                                 static_cast<std::streamsize>(actual.size())) ||
+                    actual != expected)
+                    return std::unexpected(make_error_code(error::io_error));
+            }
+
+            if (finished)
+                return checkpoint;
+
+            return base64_encode_file_range(input_path, output_path, consumed,
+                                            no_size_limit, chars, chunk_size);
+        }
+        catch (const std::exception&)
+        {
+            return std::unexpected(make_error_code(error::io_error));
+        }
+    }
+
+    /**
+     * @brief Configuration of sharded encoding.
+     *
+     * @var shard_size Encoded characters per part file, rounded down to a
+     *                 multiple of 4; only the last part may be shorter
+     * @var threads Number of parts written concurrently (0 = hardware
+     *              concurrency)
+     */
+    struct shard_options
+    {
+        std::uintmax_t shard_size = 64 * 1024 * 1024;
+        unsigned threads = 0;
+    };
+
+    /**
+     * @brief One part file of a sharded encoding.
+     *
+     * @var path Part file, relative to the manifest's directory
+     * @var input_offset Offset of the first input byte it encodes
+     * @var encoded_offset Offset of its first character in the whole encoding
+     * @var size Number of encoded characters it holds
+     */
+    struct encoded_shard
+    {
+        std::filesystem::path path;
+        std::uintmax_t input_offset = 0;
+        std::uintmax_t encoded_offset = 0;
+        std::uintmax_t size = 0;
+    };
+
+    /**
+     * @brief Layout of a sharded encoding, as stored in its manifest file.
+     */
+    struct shard_manifest
+    {
+        std::uintmax_t input_size = 0;
+        std::uintmax_t encoded_size = 0;
+        std::vector<encoded_shard> shards;
+    };
+
+    namespace detail
+    {
+        constexpr std::string_view manifest_header = "base64-shards 1";
+
+        // Largest input whose encoded size fits in std::uintmax_t
+        constexpr std::uintmax_t max_encodable_size =
+            std::numeric_limits<std::uintmax_t>::max() / 4 * 3;
+
+        // Text format: header, sizes and shard count, then one line per shard
+        [[nodiscard]] inline bool write_manifest(
+            const std::filesystem::path& path, const shard_manifest& manifest)
+        {
+            std::ofstream out(path);
+            out << manifest_header << '\n' << manifest.input_size << ' '
+                << manifest.encoded_size << ' ' << manifest.shards.size()
+                << '\n';
+            for (const auto& shard : manifest.shards)
+                out << shard.input_offset << ' ' << shard.encoded_offset << ' '
+                    << shard.size << ' ' << shard.path.string() << '\n';
+            return static_cast<bool>(out.flush());
+        }
+
+        [[nodiscard]] inline std::expected<shard_manifest, std::error_code>
+        read_manifest(const std::filesystem::path& path)
+        {
+            std::ifstream in(path);
+            if (!in.is_open())
+                return std::unexpected(make_error_code(
+                    std::filesystem::exists(path)
+                        ? error::file_not_readable
+                        : error::file_not_found));
+
+            std::string header;
+            shard_manifest manifest;
+            size_t count = 0;
+            if (!std::getline(in, header) || header != manifest_header ||
+                !(in >> manifest.input_size >> manifest.encoded_size >> count))
+                return std::unexpected(make_error_code(error::io_error));
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                encoded_shard shard;
+                std::string name;
+                if (!(in >> shard.input_offset >> shard.encoded_offset >>
+                    shard.size) || in.get() != ' ' || !std::getline(in, name))
+                    return std::unexpected(make_error_code(error::io_error));
+
+                // Parts must be plain file names next to the manifest
+                shard.path = name;
+                if (name.empty() || name == "." || name == ".." ||
+                    shard.path.has_root_path() ||
+                    shard.path != shard.path.filename())
+                    return std::unexpected(make_error_code(error::io_error));
+                manifest.shards.push_back(std::move(shard));
+            }
+
+            // Shards must tile the encoding in whole quads
+            std::uintmax_t next = 0;
+            for (const auto& shard : manifest.shards)
+            {
+                if (shard.encoded_offset != next || shard.size == 0 ||
+                    shard.encoded_offset % 4 != 0 ||
+                    shard.input_offset != shard.encoded_offset / 4 * 3)
+                    return std::unexpected(
+                        make_error_code(error::invalid_length));
+                next += shard.size;
+            }
+            if (next != manifest.encoded_size || next % 4 != 0 ||
+                manifest.input_size > max_encodable_size ||
+                (manifest.input_size + 2) / 3 * 4 != next)
+                return std::unexpected(make_error_code(error::invalid_length));
+
+            return manifest;
+        }
+
+        // Records the first error reported by any worker
+        class first_error
+        {
+            std::mutex mutex_;
+            std::error_code error_;
+            std::atomic<bool> failed_{false};
+
+        public:
+            void set(const std::error_code error)
+            {
+                std::scoped_lock lock(mutex_);
+                if (!error_)
+                    error_ = error;
+                failed_.store(true, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] bool failed() const noexcept
+            {
+                return failed_.load(std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] std::error_code get()
+            {
+                std::scoped_lock lock(mutex_);
+                return error_;
+            }
+        };
+    } // namespace detail
+
+    /**
+     * @brief Encodes a file into part files of a fixed encoded size in parallel.
+     *
+     * Parts are named output_prefix.part00000, .part00001, ... and every
+     * part but the last holds exactly shard_size characters, so shard
+     * boundaries fall on quads and each part is valid Base64 on its own
+     * (only the last one carries padding). Parts are written concurrently,
+     * after which output_prefix.manifest records their offsets. On error
+     * the parts this call wrote are removed, together with any manifest
+     * left at output_prefix.manifest by an earlier run, since its parts
+     * may have been overwritten.
+     *
+     * @param pool Pool that writes the parts
+     * @param input_path Path to the input file
+     * @param output_prefix Path prefix of the part and manifest files
+     * @param options Shard size and number of parts written concurrently
+     * @param chars Character set to use (default: standard Base64)
+     * @return The manifest, or error
+     */
+    [[nodiscard]] inline std::expected<shard_manifest, std::error_code>
+    base64_encode_file_sharded(
+        thread_pool& pool,
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_prefix,
+        const shard_options& options = {},
+        const std::string_view chars = base64_chars)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return std::unexpected(
+                    make_error_code(detail::charset_error(chars)));
+
+            const auto file_size = detail::input_size(input_path,
+                                                      no_size_limit);
+            if (!file_size)
+                return std::unexpected(file_size.error());
+            if (!*file_size)
+                return std::unexpected(make_error_code(error::empty_data));
+
+            if (**file_size > detail::max_encodable_size)
+                return std::unexpected(make_error_code(error::file_too_large));
+
+            shard_manifest manifest;
+            manifest.input_size = **file_size;
+            manifest.encoded_size = (manifest.input_size + 2) / 3 * 4;
+
+            const std::uintmax_t shard_size = std::max<std::uintmax_t>(
+                options.shard_size / 4 * 4, 4);
+            for (std::uintmax_t offset = 0; offset < manifest.encoded_size;
+                 offset += shard_size)
+            {
+                const auto index = std::to_string(manifest.shards.size());
+                auto path = output_prefix;
+                path += ".part" + std::string(5 - std::min<size_t>(
+                    index.size(), 5), '0') + index;
+                manifest.shards.push_back({
+                    std::move(path), offset / 4 * 3, offset,
+                    std::min(shard_size, manifest.encoded_size - offset)
+                });
+            }
+
+            const unsigned workers = static_cast<unsigned>(std::min<size_t>(
+                detail::resolve_workers(
+                    parallel_options{options.threads, 0},
+                    static_cast<size_t>(std::min<std::uintmax_t>(
+                        manifest.input_size,
+                        std::numeric_limits<size_t>::max()))),
+                manifest.shards.size()));
+            detail::first_error failure;
+            // Parts opened for writing by this call, removed on error
+            std::vector<char> written(manifest.shards.size());
+
+            auto manifest_path = output_prefix;
+            manifest_path += ".manifest";
+            const auto fail = [&](const std::error_code error)
+            {
+                std::error_code ec;
+                for (size_t i = 0; i < written.size(); ++i)
+                    if (written[i])
+                        std::filesystem::remove(manifest.shards[i].path, ec);
+                std::filesystem::remove(manifest_path, ec);
+                return std::unexpected(error);
+            };
+
+            detail::parallel_for_ranges(
+                pool, manifest.shards.size(), workers,
+                [&](const size_t first, const size_t last)
+                {
+                    try
+                    {
+                        std::ifstream input(input_path, std::ios::binary);
+                        std::vector<std::byte> buffer(
+                            detail::default_chunk_size);
+                        std::string encoded(
+                            detail::encoded_size(buffer.size()), '\0');
+
+                        for (size_t i = first; i < last && !failure.failed();
+                             ++i)
+                        {
+                            const auto& shard = manifest.shards[i];
+                            std::ofstream output(shard.path, std::ios::binary);
+                            input.seekg(static_cast<std::streamoff>(
+                                shard.input_offset));
+                            if (output.is_open())
+                                written[i] = 1;
+                            if (!input || !output.is_open())
+                                return failure.set(
+                                    make_error_code(error::io_error));
+
+                            const std::uintmax_t end = std::min(
+                                manifest.input_size,
+                                shard.input_offset + shard.size / 4 * 3);
+                            for (std::uintmax_t offset = shard.input_offset;
+                                 offset < end; offset += buffer.size())
+                            {
+                                const auto size = static_cast<size_t>(
+                                    std::min<std::uintmax_t>(
+                                        buffer.size(), end - offset));
+                                if (!input.read(reinterpret_cast<char*>(
+                                        buffer.data()),
+                                    static_cast<std::streamsize>(size)))
+                                    return failure.set(
+                                        make_error_code(error::io_error));
+
+                                const char* encoded_end = detail::encode_into(
+                                    {buffer.data(), size}, encoded.data(),
+                                    chars);
+                                if (!output.write(encoded.data(),
+                                                  encoded_end - encoded.data()))
+                                    return failure.set(
+                                        make_error_code(error::io_error));
+                            }
+
+                            if (!output.flush())
+                                return failure.set(
+                                    make_error_code(error::io_error));
+                        }
+                    }
+                    catch (const std::exception&)
+                    {
+                        failure.set(make_error_code(error::io_error));
+                    }
+                });
+
+            if (failure.failed())
+                return fail(failure.get());
+
+            // Part paths in the manifest are relative to it
+            auto relative = manifest;
+            for (auto& shard : relative.shards)
+                shard.path = shard.path.filename();
+
+            if (!detail::write_manifest(manifest_path, relative))
+                return fail(make_error_code(error::io_error));
+
+            return relative;
+        }
+        catch (const std::exception&)
+        {
+            return std::unexpected(make_error_code(error::io_error));
+        }
+    }
+
+    /**
+     * @brief Encodes a file into part files on the default_thread_pool().
+     */
+    [[nodiscard]] inline std::expected<shard_manifest, std::error_code>
+    base64_encode_file_sharded(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_prefix,
+        const shard_options& options = {},
+        const std::string_view chars = base64_chars)
+    {
+        return base64_encode_file_sharded(default_thread_pool(), input_path,
+                                          output_prefix, options, chars);
+    }
+
+    /**
+     * @brief Reassembles and decodes the parts listed in a shard manifest.
+     *
+     * The output is sized up front; workers decode different parts
+     * concurrently and write them at their positions in the output.
+     * Part names must be plain file names in the manifest's directory.
+     *
+     * @param pool Pool that decodes the parts
+     * @param manifest_path Manifest written by base64_encode_file_sharded()
+     * @param output_path Path where to write the decoded bytes
+     * @param options Number of parts decoded concurrently (shard_size is
+     *                ignored)
+     * @param chars Character set to use (default: standard Base64)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_decode_sharded(
+        thread_pool& pool,
+        const std::filesystem::path& manifest_path,
+        const std::filesystem::path& output_path,
+        const shard_options& options = {},
+        const std::string_view chars = base64_chars)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return make_error_code(detail::charset_error(chars));
+
+            const auto manifest = detail::read_manifest(manifest_path);
+            if (!manifest)
+                return manifest.error();
+            if (manifest->shards.empty())
+                return make_error_code(error::empty_data);
+
+            // Sized up front, so that parts can be written in any order
+            std::ofstream(output_path, std::ios::binary);
+            std::filesystem::resize_file(output_path, manifest->input_size);
+
+            const auto table = detail::make_decode_table(chars);
+            const auto directory = manifest_path.parent_path();
+            const unsigned workers = static_cast<unsigned>(std::min<size_t>(
+                detail::resolve_workers(
+                    parallel_options{options.threads, 0},
+                    static_cast<size_t>(manifest->encoded_size)),
+                manifest->shards.size()));
+            detail::first_error failure;
+
+            detail::parallel_for_ranges(
+                pool, manifest->shards.size(), workers,
+                [&](const size_t first, const size_t last)
+                {
+                    try
+                    {
+                        std::ofstream output(output_path, std::ios::binary |
+                                             std::ios::in | std::ios::out);
+                        std::string text(64 * 1024, '\0');
+                        std::vector<std::byte> decoded(text.size() / 4 * 3);
+
+                        for (size_t i = first; i < last && !failure.failed();
+                             ++i)
+                        {
+                            const auto& shard = manifest->shards[i];
+                            const bool last_shard =
+                                i + 1 == manifest->shards.size();
+                            const auto part_path = directory / shard.path;
+
+                            std::error_code ec;
+                            if (std::filesystem::file_size(part_path, ec) !=
+                                shard.size || ec)
+                                return failure.set(make_error_code(
+                                    ec ? error::file_not_found
+                                       : error::invalid_length));
+
+                            std::ifstream input(part_path, std::ios::binary);
+                            output.seekp(static_cast<std::streamoff>(
+                                shard.input_offset));
+                            if (!input.is_open() || !output)
+                                return failure.set(
+                                    make_error_code(error::io_error));
+
+                            std::uintmax_t expected_end = manifest->input_size;
+                            for (std::uintmax_t done = 0; done < shard.size;)
+                            {
+                                const auto size = static_cast<size_t>(
+                                    std::min<std::uintmax_t>(
+                                        text.size(), shard.size - done));
+                                if (!input.read(text.data(),
+                                                static_cast<std::streamsize>(
+                                                    size)))
+                                    return failure.set(
+                                        make_error_code(error::io_error));
+
+                                done += size;
+                                const bool is_last = last_shard &&
+                                    done == shard.size;
+                                const auto end = detail::decode_into(
+                                    {text.data(), size}, decoded.data(), table,
+                                    is_last);
+                                if (!end)
+                                    return failure.set(make_error_code(
+                                        error::invalid_character));
+
+                                const auto length = *end - decoded.data();
+                                if (!output.write(reinterpret_cast<const char*>(
+                                        decoded.data()), length))
+                                    return failure.set(
+                                        make_error_code(error::io_error));
+
+                                if (is_last)
+                                    expected_end = shard.input_offset +
+                                        (done - size) / 4 * 3 +
+                                        static_cast<std::uintmax_t>(length);
+                            }
+
+                            if (expected_end != manifest->input_size)
+                                return failure.set(
+                                    make_error_code(error::invalid_length));
+                        }
+
+                        if (!output.flush())
+                            failure.set(make_error_code(error::io_error));
+                    }
+                    catch (const std::exception&)
+                    {
+                        failure.set(make_error_code(error::io_error));
+                    }
+                });
+
+            if (failure.failed())
+                return failure.get();
+
+            return {};
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+    /**
+     * @brief Decodes the parts listed in a shard manifest on the default_thread_pool().
+     */
+    [[nodiscard]] inline std::error_code base64_decode_sharded(
+        const std::filesystem::path& manifest_path,
+        const std::filesystem::path& output_path,
+        const shard_options& options = {},
+        const std::string_view chars = base64_chars)
+    {
+        return base64_decode_sharded(default_thread_pool(), manifest_path,
+                                     output_path, options, chars);
+    }
+
+    /**
+     * @brief Resumable position of a tail_encoder.
+     *
+     * @var offset Input bytes read so far, including the carry
+     * @var carry Trailing bytes not yet forming a whole triple
+     * @var carry_size Number of valid bytes in carry (0-2)
+     */
+    struct tail_state
+    {
+        std::uintmax_t offset = 0;
+        std::array<std::byte, 2> carry{};
+        std::uint8_t carry_size = 0;
+    };
+
+    /**
+     * @brief Incrementally encodes a growing, append-only file.
+     *
+     * Each poll() encodes only the bytes appended since the previous one
+     * and appends whole quads to the output; up to two trailing bytes are
+     * carried until more data arrives or finish() pads them. The cost of a
+     * poll is a stat plus the new data, so it suits timers and inotify
+     * events alike. state() can be persisted to continue in a later run.
+     */
+    class tail_encoder
+    {
+        std::filesystem::path input_path_;
+        std::ifstream input_;
+        std::ofstream output_;
+        const std::string chars_;
+        std::error_code charset_error_;
+        std::vector<std::byte> buffer_;
+        std::string encoded_;
+        tail_state state_;
+
+    public:
+        /**
+         * @param input_path File to follow
+         * @param output_path File the encoding is appended to; it must hold
+         *                    exactly the output belonging to state
+         * @param state Position to continue from (default: the start)
+         * @param chars Character set to use (default: standard Base64); it
+         *              is copied, so it need not outlive the encoder
+         * @param chunk_size Size of chunks to read (default: 48KB)
+         */
+        tail_encoder(std::filesystem::path input_path,
+                     const std::filesystem::path& output_path,
+                     const tail_state& state = {},
+                     const std::string_view chars = base64_chars,
+                     const size_t chunk_size = detail::default_chunk_size)
+            : input_path_(std::move(input_path))
+              , input_(input_path_, std::ios::binary)
+              , output_(output_path, std::ios::binary | std::ios::app)
+              , chars_(chars)
+              , buffer_(std::max<size_t>(chunk_size / 3 * 3, 3))
+              , encoded_(detail::encoded_size(buffer_.size()), '\0')
+              , state_(state)
+        {
+            if (!detail::validate_charset(chars_))
+                charset_error_ = make_error_code(detail::charset_error(chars_));
+        }
+
+        /**
+         * @brief Encodes the data appended since the last poll.
+         *
+         * @return Number of new input bytes, or error (file_not_found,
+         *         invalid_character_set_*, or io_error if the file shrank or
+         *         the output cannot be written)
+         */
+        [[nodiscard]] std::expected<std::uintmax_t, std::error_code> poll()
+        {
+            if (charset_error_)
+                return std::unexpected(charset_error_);
+
+            std::error_code ec;
+            const auto size = std::filesystem::file_size(input_path_, ec);
+            if (ec)
+                return std::unexpected(make_error_code(error::file_not_found));
+            if (size < state_.offset)
+                return std::unexpected(make_error_code(error::io_error));
+            if (size == state_.offset)
+                return 0;
+
+            // The file may not have existed when following started
+            if (!input_.is_open())
+                input_.open(input_path_, std::ios::binary);
+            if (!input_.is_open())
+                return std::unexpected(
+                    make_error_code(error::file_not_readable));
+            if (!output_.is_open())
+                return std::unexpected(make_error_code(error::io_error));
+
+            try
+            {
+                input_.clear();
+                input_.seekg(static_cast<std::streamoff>(state_.offset));
+
+                const std::uintmax_t start = state_.offset;
+                while (state_.offset < size)
+                {
+                    // The carried bytes lead the next triple
+                    std::copy_n(state_.carry.begin(), state_.carry_size,
+                                buffer_.begin());
+                    const size_t want = static_cast<size_t>(
+                        std::min<std::uintmax_t>(
+                            buffer_.size() - state_.carry_size,
+                            size - state_.offset));
+                    input_.read(reinterpret_cast<char*>(buffer_.data() +
+                                    state_.carry_size),
+                                static_cast<std::streamsize>(want));
+                    const auto got = static_cast<size_t>(input_.gcount());
+                    if (got == 0)
+                        break;
+
+                    const size_t available = state_.carry_size + got;
+                    const size_t whole = available / 3 * 3;
+                    const char* end = detail::encode_into(
+                        {buffer_.data(), whole}, encoded_.data(), chars_);
+                    if (!output_.write(encoded_.data(), end - encoded_.data()))
+                        return std::unexpected(
+                            make_error_code(error::io_error));
+
+                    state_.carry_size = static_cast<std::uint8_t>(
+                        available - whole);
+                    std::copy_n(buffer_.begin() + static_cast<std::ptrdiff_t>(
+                                    whole), state_.carry_size,
+                                state_.carry.begin());
+                    state_.offset += got;
+                }
+
+                if (input_.bad() || !output_.flush())
+                    return std::unexpected(make_error_code(error::io_error));
+
+                return state_.offset - start;
+            }
+            catch (const std::exception&)
+            {
+                return std::unexpected(make_error_code(error::io_error));
+            }
+        }
+
+        /**
+         * @brief Pads and writes the carried bytes once the file is complete.
+         *
+         * Nothing may be appended to the output afterwards.
+         */
+        [[nodiscard]] std::error_code finish()
+        {
+            if (charset_error_)
+                return charset_error_;
+
+            if (state_.carry_size != 0)
+            {
+                const char* end = detail::encode_into(
+                    {state_.carry.data(), state_.carry_size}, encoded_.data(),
+                    chars_);
+                if (!output_.write(encoded_.data(), end - encoded_.data()))
+                    return make_error_code(error::io_error);
+                state_.carry_size = 0;
+            }
+
+            if (!output_.flush())
+                return make_error_code(error::io_error);
+
+            return {};
+        }
+
+        [[nodiscard]] const tail_state& state() const noexcept
+        {
+            return state_;
+        }
+    };
+
+    /**
+     * @brief Result of base64_verify_file: std::nullopt if the files match,
+     * otherwise the offset of the first differing character of the encoded file.
+     */
+    using verify_result =
+    std::expected<std::optional<std::uintmax_t>, std::error_code>;
+
+    /**
+     * @brief Checks that a file holds the Base64 encoding of another file.
+     *
+     * Both files are streamed in lockstep: each chunk of the data file is
+     * encoded and compared (memcmp, vectorized by the C library) with the
+     * same range of the encoded file, so memory use is bounded by the chunk
+     * size and the check stops at the first divergence. The encoding must
+     * be the canonical one; a truncated encoded file or trailing bytes
+     * after the encoding count as a mismatch.
+     *
+     * @param data_path Path to the original data
+     * @param encoded_path Path to the encoded file to check
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @return verify_result First mismatch offset, std::nullopt, or error
+     */
+    [[nodiscard]] inline verify_result base64_verify_file(
+        const std::filesystem::path& data_path,
+        const std::filesystem::path& encoded_path,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return std::unexpected(
+                    make_error_code(detail::charset_error(chars)));
+
+            for (const auto& path : {data_path, encoded_path})
+            {
+                if (const auto size = detail::input_size(path, no_size_limit);
+                    !size)
+                    return std::unexpected(size.error());
+            }
+
+            std::ifstream data(data_path, std::ios::binary);
+            std::ifstream encoded(encoded_path, std::ios::binary);
+            if (!data.is_open() || !encoded.is_open())
+                return std::unexpected(make_error_code(error::file_not_readable));
+
+            // Full chunks are whole triples, so no carry is needed
+            const size_t chunk = std::max<size_t>(
+                detail::resolve_chunk_size(chunk_size, data_path) / 3 * 3, 3);
+            std::vector<std::byte> input(chunk);
+            std::string expected(detail::encoded_size(chunk), '\0');
+            std::string actual(expected.size(), '\0');
+
+            std::uintmax_t offset = 0;
+            while (data)
+            {
+                data.read(reinterpret_cast<char*>(input.data()),
+                          static_cast<std::streamsize>(input.size()));
+                const auto bytes_read = static_cast<size_t>(data.gcount());
+                if (bytes_read == 0)
+                    break;
+
+                const size_t length = static_cast<size_t>(
+                    detail::encode_into({input.data(), bytes_read},
+                                        expected.data(), chars) -
+                    expected.data());
+
+                encoded.read(actual.data(),
+                             static_cast<std::streamsize>(length));
+                const auto compared = static_cast<size_t>(encoded.gcount());
+                if (encoded.bad())
+                    return std::unexpected(make_error_code(error::io_error));
+
+                if (compared != length ||
+                    std::memcmp(expected.data(), actual.data(), length) != 0)
+                {
+                    const auto [mismatch, _] = std::mismatch(
+                        expected.data(), expected.data() + compared,
+                        actual.data());
+                    return offset + static_cast<std::uintmax_t>(
+                        mismatch - expected.data());
+                }
+
+                offset += length;
+            }
+
+            if (data.bad())
+                return std::unexpected(make_error_code(error::io_error));
+
+            if (offset == 0)
+                return std::unexpected(make_error_code(error::empty_data));
+
+            // Anything after the encoding is a mismatch as well
+            if (encoded.peek() != std::ifstream::traits_type::eof())
+                return offset;
+
+            return std::nullopt;
+        }
+        catch (const std::exception&)
+        {
+            return std::unexpected(make_error_code(error::io_error));
+        }
+    }
+
+    /**
+     * @brief Encodes a file into Base64 and writes to an output file using multiple threads.
+     *
+     * The input file is memory mapped and the output preallocated to the
+     * exact encoded size. Workers encode disjoint 3-byte aligned input
+     * ranges and pwrite() them at the matching output offsets. Files that
+     * cannot be mapped, and non-POSIX platforms, use the streaming encoder.
+     *
+     * @param input_path Path to the input file
+     * @param output_path Path where to write the encoded result
+     * @param options Thread count and single-thread threshold
+     * @param chars Character set to use (default: standard Base64)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_encode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        const parallel_options& options,
+        const std::string_view chars = base64_chars,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return make_error_code(detail::charset_error(chars));
+
+            const auto probed = detail::input_size(input_path, max_size);
+            if (!probed)
+                return probed.error();
+
+            // Inputs without a reliable size, or too large for positional
+            // I/O on this platform, are read sequentially
+            if (!*probed || !detail::fits_positional_io(**probed))
+                return base64_encode_file_to_file(input_path, output_path,
+                                                  chars,
+                                                  detail::default_chunk_size,
+                                                  max_size);
+            const std::uintmax_t file_size = **probed;
+
+#if BASE64_POSIX_IO
+            if (const auto mapping = detail::mapped_file::open(
+                input_path, file_size))
+            {
+                const auto input = mapping->bytes();
+
+                const detail::unique_fd output(::open(
+                    output_path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666));
+                if (!output || !detail::preallocate(
+                    output.get(), detail::encoded_size(input.size())))
+                    return make_error_code(error::io_error);
+
+                const unsigned workers = detail::resolve_workers(
+                    options, input.size());
+                const size_t triples = (input.size() + 2) / 3;
+                std::atomic<bool> write_failed{false};
+
+                detail::parallel_for_ranges(
+                    triples, workers,
+                    [&](const size_t first, const size_t last)
+                    {
+                        // Encode through a small buffer in 48KB input blocks
+                        constexpr size_t block = detail::default_chunk_size;
+                        std::string buffer(detail::encoded_size(block), '\0');
+
+                        const size_t end = std::min(last * 3, input.size());
+                        for (size_t offset = first * 3; offset < end;
+                             offset += block)
+                        {
+                            if (write_failed.load(std::memory_order_relaxed))
+                                return;
+
+                            const char* encoded_end = detail::encode_into(
+                                input.subspan(offset,
+                                              std::min(block, end - offset)),
+                                buffer.data(), chars);
+
+                            if (!detail::write_all_at(
+                                output.get(), buffer.data(),
+                                static_cast<size_t>(encoded_end - buffer.data()),
+                                static_cast<off_t>(offset / 3 * 4)))
+                            {
+                                write_failed = true;
+                                return;
+                            }
+                        }
+                    });
+
+                if (write_failed)
+                    return make_error_code(error::io_error);
+
+                return {};
+            }
+#endif
+
+            return base64_encode_file_to_file(input_path, output_path, chars,
+                                              detail::default_chunk_size,
+                                              max_size);
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+    /**
+     * @brief Decodes a Base64-encoded file into an output file using multiple threads.
+     *
+     * The encoded file is memory mapped and the output preallocated to the
+     * exact decoded size. Workers decode 4-character aligned regions and
+     * pwrite() them at their final offsets; only the last region may hold
+     * padding. Files that cannot be mapped, and non-POSIX platforms, use the
+     * streaming decoder instead.
+     *
+     * @param input_path Path to the encoded file
+     * @param output_path Path where to write the decoded bytes
+     * @param options Thread count and single-thread threshold
+     * @param chars Character set to use (default: standard Base64)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return decode_file_result Nothing, or the error and, for an invalid
+     *         character, its offset in the encoded file
+     */
+    [[nodiscard]] inline decode_file_result base64_decode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        const parallel_options& options,
+        const std::string_view chars = base64_chars,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        const auto fail = [](const std::error_code error,
+                             const std::optional<std::uintmax_t> offset = {})
+        {
+            return std::unexpected(decode_file_error{error, offset});
+        };
+        const auto stream = [&]() -> decode_file_result
+        {
+            std::optional<std::uintmax_t> invalid_offset;
+            if (const auto error = detail::decode_file_streaming(
+                input_path, output_path, chars, detail::default_chunk_size,
+                max_size, invalid_offset))
+                return fail(error, invalid_offset);
+            return {};
+        };
+
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return fail(make_error_code(detail::charset_error(chars)));
+
+            const auto probed = detail::input_size(input_path, max_size);
+            if (!probed)
+                return fail(probed.error());
+
+            // Inputs without a reliable size, or too large for positional
+            // I/O on this platform, are read sequentially
+            if (!*probed || !detail::fits_positional_io(**probed))
+                return stream();
+            const std::uintmax_t file_size = **probed;
+
+            if (file_size % 4 != 0)
+                return fail(make_error_code(error::invalid_length));
+
+#if BASE64_POSIX_IO
+            if (const auto mapping = detail::mapped_file::open(
+                input_path, file_size))
+            {
+                const std::string_view input(
+                    reinterpret_cast<const char*>(mapping->bytes().data()),
+                    mapping->bytes().size());
+
+                const detail::unique_fd output(::open(
+                    output_path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666));
+                if (!output || !detail::preallocate(
+                    output.get(), detail::decoded_size(input)))
+                    return fail(make_error_code(error::io_error));
+
+                const auto table = detail::make_decode_table(chars);
+                const unsigned workers = detail::resolve_workers(
+                    options, input.size());
+                const size_t quads = input.size() / 4;
+
+                std::atomic<size_t> first_invalid{SIZE_MAX};
+                std::atomic<bool> write_failed{false};
+
+                detail::parallel_for_ranges(
+                    quads, workers,
+                    [&](const size_t first, const size_t last)
+                    {
+                        // Decode through a small buffer in 64KB input blocks
+                        constexpr size_t block = detail::default_chunk_size /
+                            3 * 4;
+                        std::vector<std::byte> buffer(block / 4 * 3);
+
+                        for (size_t offset = first * 4; offset < last * 4;
+                             offset += block)
+                        {
+                            if (first_invalid.load(std::memory_order_relaxed) <
+                                offset || write_failed.load(
+                                    std::memory_order_relaxed))
+                                return;
+
+                            const auto slice = input.substr(
+                                offset, std::min(block, last * 4 - offset));
+                            const auto end = detail::decode_into(
+                                slice, buffer.data(), table,
+                                offset + slice.size() == input.size());
+                            if (!end)
+                            {
+                                size_t current = first_invalid.load();
+                                const size_t found = offset + end.error();
+                                while (found < current &&
+                                    !first_invalid.compare_exchange_weak(
+                                        current, found))
+                                {
+                                }
+                                return;
+                            }
+
+                            if (!detail::write_all_at(
+                                output.get(), buffer.data(),
+                                static_cast<size_t>(*end - buffer.data()),
+                                static_cast<off_t>(offset / 4 * 3)))
+                            {
+                                write_failed = true;
+                                return;
+                            }
+                        }
+                    });
+
+                if (const size_t found = first_invalid.load();
+                    found != SIZE_MAX)
+                    return fail(make_error_code(error::invalid_character),
+                                found);
+
+                if (write_failed)
+                    return fail(make_error_code(error::io_error));
+
+                return {};
+            }
+#endif
+
+            return stream();
+        }
+        catch (const std::exception&)
+        {
+            return fail(make_error_code(error::io_error));
+        }
+    }
+
+    /**
+     * @brief Configuration of the pipelined file-to-file encoder.
+     *
+     * @var workers       Encoder threads (0: std::thread::hardware_concurrency())
+     * @var chunk_size    Input bytes per chunk, rounded down to a multiple of 3 (default: 768KB)
+     * @var max_in_flight Chunks allocated at once, bounding memory use (0: two per worker)
+     */
+    struct pipeline_options
+    {
+        unsigned workers = 0;
+        size_t chunk_size = 768 * 1024;
+        size_t max_in_flight = 0;
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Blocking multi-producer/multi-consumer FIFO with a fixed capacity.
+         *
+         * Once closed, push() fails and pop() drains the remaining items
+         * before returning std::nullopt.
+         */
+        template <typename T>
+        class bounded_queue
+        {
+            std::mutex mutex_;
+            std::condition_variable not_empty_;
+            std::condition_variable not_full_;
+            std::deque<T> items_;
+            const size_t capacity_;
+            bool closed_ = false;
+
+        public:
+            explicit bounded_queue(const size_t capacity)
+                : capacity_(capacity)
+            {
+            }
+
+            bool push(T item)
+            {
+                std::unique_lock lock(mutex_);
+                not_full_.wait(lock, [this]
+                {
+                    return closed_ || items_.size() < capacity_;
+                });
+                if (closed_)
+                    return false;
+
+                items_.push_back(std::move(item));
+                not_empty_.notify_one();
+                return true;
+            }
+
+            [[nodiscard]] std::optional<T> pop()
+            {
+                std::unique_lock lock(mutex_);
+                not_empty_.wait(lock, [this]
+                {
+                    return closed_ || !items_.empty();
+                });
+                if (items_.empty())
+                    return std::nullopt;
+
+                T item = std::move(items_.front());
+                items_.pop_front();
+                not_full_.notify_one();
+                return item;
+            }
+
+            void close()
+            {
+                {
+                    std::scoped_lock lock(mutex_);
+                    closed_ = true;
+                }
+                not_empty_.notify_all();
+                not_full_.notify_all();
+            }
+        };
+
+        // Buffers of one in-flight chunk, recycled between reader, encoders and writer
+        struct pipeline_chunk
+        {
+            size_t index = 0;
+            std::vector<std::byte> input;
+            size_t input_size = 0;
+            std::string output;
+            size_t output_size = 0;
+        };
+    } // namespace detail
+
+    /**
+     * @brief Encodes a file into Base64 through a reader / encoders / ordered writer pipeline.
+     *
+     * A reader thread fills 3-byte aligned chunks, several encoder threads
+     * encode them concurrently and the calling thread writes them back in
+     * input order, so disk I/O and encoding overlap. The stages exchange a
+     * fixed set of max_in_flight recycled chunks through bounded queues,
+     * capping memory at max_in_flight * chunk_size * 7/3 bytes.
+     *
+     * @param input_path Path to the input file
+     * @param output_path Path where to write the encoded result
+     * @param options Worker count, chunk size and in-flight chunk limit
+     * @param chars Character set to use (default: standard Base64)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_encode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        const pipeline_options& options,
+        const std::string_view chars = base64_chars,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return make_error_code(detail::charset_error(chars));
+
+            const auto probed = detail::input_size(input_path, max_size);
+            if (!probed)
+                return probed.error();
+
+            // Inputs without a reliable size can only be read sequentially
+            if (!*probed)
+                return base64_encode_file_to_file(input_path, output_path,
+                                                  chars,
+                                                  detail::default_chunk_size,
+                                                  max_size);
+
+            std::ifstream input(input_path, std::ios::binary);
+            if (!input.is_open())
+                return make_error_code(error::file_not_readable);
+
+            std::ofstream output(output_path, std::ios::binary);
+            if (!output.is_open())
+                return make_error_code(error::io_error);
+
+            const unsigned workers = std::max(
+                options.workers != 0
+                    ? options.workers
+                    : std::thread::hardware_concurrency(), 1u);
+            const size_t chunk_size = std::max<size_t>(
+                options.chunk_size / 3 * 3, 3);
+            const size_t in_flight = std::max<size_t>(
+                options.max_in_flight != 0
+                    ? options.max_in_flight
+                    : size_t{2} * workers, 1);
+
+            std::vector<detail::pipeline_chunk> chunks(in_flight);
+            detail::bounded_queue<detail::pipeline_chunk*> free_chunks(in_flight);
+            detail::bounded_queue<detail::pipeline_chunk*> to_encode(in_flight);
+            detail::bounded_queue<detail::pipeline_chunk*> to_write(in_flight);
+
+            for (auto& chunk : chunks)
+            {
+                chunk.input.resize(chunk_size);
+                chunk.output.resize(detail::encoded_size(chunk_size));
+                free_chunks.push(&chunk);
+            }
+
+            std::atomic<bool> read_failed{false};
+            std::atomic<unsigned> running_encoders{workers};
+
+            std::jthread reader([&]
+            {
+                for (size_t index = 0;; ++index)
+                {
+                    const auto chunk = free_chunks.pop();
+                    if (!chunk)
+                        break;
+
+                    input.read(reinterpret_cast<char*>((*chunk)->input.data()),
+                               static_cast<std::streamsize>(chunk_size));
+                    if (input.bad())
+                    {
+                        read_failed = true;
+                        break;
+                    }
+
+                    (*chunk)->index = index;
+                    (*chunk)->input_size = static_cast<size_t>(input.gcount());
+                    if ((*chunk)->input_size == 0 || !to_encode.push(*chunk))
+                        break;
+
+                    if ((*chunk)->input_size < chunk_size)
+                        break;
+                }
+                to_encode.close();
+            });
+
+            std::vector<std::jthread> encoders;
+            try
+            {
+                encoders.reserve(workers);
+                for (unsigned w = 0; w < workers; ++w)
+                {
+                    encoders.emplace_back([&]
+                    {
+                        while (const auto chunk = to_encode.pop())
+                        {
+                            auto& c = **chunk;
+                            c.output_size = static_cast<size_t>(
+                                detail::encode_into(
+                                    std::span(c.input.data(), c.input_size),
+                                    c.output.data(), chars) - c.output.data());
+                            to_write.push(*chunk);
+                        }
+
+                        if (--running_encoders == 0)
+                            to_write.close();
+                    });
+                }
+            }
+            catch (...)
+            {
+                // Release the reader and the started encoders so that their
+                // jthreads can be joined during unwinding
+                free_chunks.close();
+                to_encode.close();
+                to_write.close();
+                throw;
+            }
+
+            // Chunk indices in flight never span more than in_flight slots
+            std::vector<detail::pipeline_chunk*> pending(in_flight, nullptr);
+            size_t next = 0;
+            bool write_failed = false;
+
+            while (const auto chunk = to_write.pop())
+            {
+                pending[(*chunk)->index % in_flight] = *chunk;
+
+                while (auto* ready = pending[next % in_flight])
+                {
+                    if (ready->index != next)
+                        break;
+
+                    pending[next % in_flight] = nullptr;
+                    ++next;
+
+                    if (!write_failed)
+                    {
+                        output.write(ready->output.data(),
+                                     static_cast<std::streamsize>(
+                                         ready->output_size));
+                        write_failed = !output;
+                        if (write_failed)
+                            free_chunks.close();
+                    }
+
+                    free_chunks.push(ready);
+                }
+            }
+
+            reader.join();
+            free_chunks.close();
+
+            if (read_failed || write_failed)
+                return make_error_code(error::io_error);
+
+            output.flush();
+            if (!output)
+                return make_error_code(error::io_error);
+
+            return {};
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+    /**
+     * @brief Configuration of the asynchronous (io_uring) file engine.
+     *
+     * @var queue_depth Chunks with reads or writes in flight at once
+     * @var chunk_size  Input bytes per read for encoding, rounded down to a
+     *                  multiple of 3 (decoding reads chunk_size / 3 * 4 characters)
+     */
+    struct async_io_options
+    {
+        unsigned queue_depth = 8;
+        size_t chunk_size = 192 * 1024;
+    };
+
+#if BASE64_IO_URING
+    namespace detail
+    {
+        /**
+         * @brief Minimal io_uring instance driven through the raw system calls.
+         *
+         * Owns the ring file descriptor and the shared submission/completion
+         * ring mappings. Only used from one thread.
+         */
+        class io_ring
+        {
+            unique_fd fd_;
+            void* sq_ring_ = MAP_FAILED;
+            size_t sq_ring_size_ = 0;
+            void* cq_ring_ = MAP_FAILED;
+            size_t cq_ring_size_ = 0;
+            io_uring_sqe* sqes_ = nullptr;
+            size_t sqes_size_ = 0;
+
+            unsigned* sq_head_ = nullptr;
+            unsigned* sq_tail_ = nullptr;
+            unsigned* sq_array_ = nullptr;
+            unsigned sq_mask_ = 0;
+            unsigned sq_entries_ = 0;
+            unsigned sq_local_tail_ = 0;
+
+            unsigned* cq_head_ = nullptr;
+            unsigned* cq_tail_ = nullptr;
+            unsigned cq_mask_ = 0;
+            io_uring_cqe* cqes_ = nullptr;
+
+            io_ring() = default;
+
+            template <typename T>
+            [[nodiscard]] static T* at(void* base, const unsigned offset) noexcept
+            {
+                return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+            }
+
+        public:
+            io_ring(const io_ring&) = delete;
+            io_ring& operator=(const io_ring&) = delete;
+
+            ~io_ring()
+            {
+                // Closing the ring first lets the kernel retire it before
+                // the shared mappings go away
+                fd_.reset();
+                if (sqes_)
+                    ::munmap(sqes_, sqes_size_);
+                if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+                    ::munmap(cq_ring_, cq_ring_size_);
+                if (sq_ring_ != MAP_FAILED)
+                    ::munmap(sq_ring_, sq_ring_size_);
+            }
+
+            // Returns nullptr when io_uring is unavailable (old kernel, seccomp, ...)
+            [[nodiscard]] static std::unique_ptr<io_ring> create(
+                const unsigned entries)
+            {
+                io_uring_params params{};
+                const int fd = static_cast<int>(
+                    ::syscall(__NR_io_uring_setup, entries, &params));
+                if (fd < 0)
+                    return nullptr;
+
+                std::unique_ptr<io_ring> ring(new io_ring());
+                ring->fd_ = unique_fd(fd);
+
+                ring->sq_ring_size_ = params.sq_off.array +
+                    params.sq_entries * sizeof(unsigned);
+                ring->cq_ring_size_ = params.cq_off.cqes +
+                    params.cq_entries * sizeof(io_uring_cqe);
+
+                bool single_mmap = false;
+#if defined(IORING_FEAT_SINGLE_MMAP)
+                single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+                if (single_mmap)
+                    ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(
+                        ring->sq_ring_size_, ring->cq_ring_size_);
+
+                ring->sq_ring_ = ::mmap(nullptr, ring->sq_ring_size_,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE, fd,
+                                        IORING_OFF_SQ_RING);
+                if (ring->sq_ring_ == MAP_FAILED)
+                    return nullptr;
+
+                ring->cq_ring_ = single_mmap
+                                     ? ring->sq_ring_
+                                     : ::mmap(nullptr, ring->cq_ring_size_,
+                                              PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, fd,
+                                              IORING_OFF_CQ_RING);
+                if (ring->cq_ring_ == MAP_FAILED)
+                    return nullptr;
+
+                ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+                void* sqes = ::mmap(nullptr, ring->sqes_size_,
+                                    PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, fd,
+                                    IORING_OFF_SQES);
+                if (sqes == MAP_FAILED)
+                    return nullptr;
+                ring->sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+                auto* sq = ring->sq_ring_;
+                ring->sq_head_ = at<unsigned>(sq, params.sq_off.head);
+                ring->sq_tail_ = at<unsigned>(sq, params.sq_off.tail);
+                ring->sq_array_ = at<unsigned>(sq, params.sq_off.array);
+                ring->sq_mask_ = *at<unsigned>(sq, params.sq_off.ring_mask);
+                ring->sq_entries_ = params.sq_entries;
+                ring->sq_local_tail_ = *ring->sq_tail_;
+
+                auto* cq = ring->cq_ring_;
+                ring->cq_head_ = at<unsigned>(cq, params.cq_off.head);
+                ring->cq_tail_ = at<unsigned>(cq, params.cq_off.tail);
+                ring->cq_mask_ = *at<unsigned>(cq, params.cq_off.ring_mask);
+                ring->cqes_ = at<io_uring_cqe>(cq, params.cq_off.cqes);
+
+                return ring;
+            }
+
+            [[nodiscard]] bool register_buffers(
+                const std::span<const iovec> buffers) noexcept
+            {
+                return ::syscall(__NR_io_uring_register, fd_.get(),
+                                 IORING_REGISTER_BUFFERS, buffers.data(),
+                                 static_cast<unsigned>(buffers.size())) == 0;
+            }
+
+            // Next free submission entry, zeroed; nullptr when the queue is full
+            [[nodiscard]] io_uring_sqe* next_sqe() noexcept
+            {
+                const unsigned head = std::atomic_ref(*sq_head_).load(
+                    std::memory_order_acquire);
+                if (sq_local_tail_ - head >= sq_entries_)
+                    return nullptr;
+
+                const unsigned index = sq_local_tail_ & sq_mask_;
+                sq_array_[index] = index;
+                ++sq_local_tail_;
+
+                io_uring_sqe* sqe = &sqes_[index];
+                std::memset(sqe, 0, sizeof(*sqe));
+                return sqe;
+            }
+
+            // Submits queued entries and waits for at least wait_for completions
+            [[nodiscard]] bool submit_and_wait(const unsigned wait_for) noexcept
+            {
+                std::atomic_ref(*sq_tail_).store(sq_local_tail_,
+                                                 std::memory_order_release);
+
+                for (;;)
+                {
+                    const unsigned head = std::atomic_ref(*sq_head_).load(
+                        std::memory_order_acquire);
+                    const long result = ::syscall(
+                        __NR_io_uring_enter, fd_.get(), sq_local_tail_ - head,
+                        wait_for, wait_for != 0 ? IORING_ENTER_GETEVENTS : 0u,
+                        nullptr, 0);
+                    if (result >= 0)
+                        return true;
+                    if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                        return false;
+                }
+            }
+
+            // Hands every available completion to fn(user_data, result)
+            template <typename Fn>
+            void for_each_completion(Fn&& fn)
+            {
+                unsigned head = *cq_head_;
+                const unsigned tail = std::atomic_ref(*cq_tail_).load(
+                    std::memory_order_acquire);
+
+                for (; head != tail; ++head)
+                {
+                    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                    fn(cqe.user_data, cqe.res);
+                }
+
+                std::atomic_ref(*cq_head_).store(head,
+                                                 std::memory_order_release);
+            }
+        };
+
+        /**
+         * @brief Streams in_fd through transform into out_fd with queue_depth chunks in flight.
+         *
+         * Each chunk is read at its input offset, transformed as soon as its
+         * read completes and written at in_offset / in_unit * out_unit, so
+         * writes land in order whatever order completions arrive in. Buffers
+         * are registered with the ring when the memlock limit allows it.
+         * Whatever fails, in-flight requests are cancelled and reaped
+         * before the buffers are freed. Only if the ring itself stops
+         * working while requests are outstanding (io_uring_enter() failing
+         * with anything but a transient error) are the buffers of that call
+         * deliberately leaked, since the kernel may still write into them.
+         *
+         * @param transform Called as transform(in_offset, input, output) and
+         *        returning the output length or an error
+         */
+        template <typename Transform>
+        [[nodiscard]] std::error_code uring_transform(
+            io_ring& ring,
+            const int in_fd,
+            const int out_fd,
+            const std::uint64_t size,
+            const size_t in_chunk,
+            const size_t out_chunk,
+            const unsigned depth,
+            const unsigned in_unit,
+            const unsigned out_unit,
+            Transform&& transform)
+        {
+            enum class state : uint8_t { idle, reading, writing };
+
+            struct slot
+            {
+                std::vector<std::byte> input;
+                std::vector<std::byte> output;
+                iovec vec{};
+                std::uint64_t offset = 0;
+                size_t size = 0;
+                size_t done = 0;
+                state current = state::idle;
+            };
+
+            std::vector<slot> slots(depth);
+            std::vector<iovec> registered;
+            for (auto& s : slots)
+            {
+                s.input.resize(in_chunk);
+                s.output.resize(out_chunk);
+                registered.push_back({s.input.data(), s.input.size()});
+                registered.push_back({s.output.data(), s.output.size()});
+            }
+            const bool fixed = ring.register_buffers(registered);
+
+            // Queues the next request of a slot; false if the ring is unusable
+            const auto queue = [&](const size_t index)
+            {
+                auto& s = slots[index];
+                const bool reading = s.current == state::reading;
+                auto* buffer = reading ? s.input.data() : s.output.data();
+
+                // A partial submit can leave the queue full: flush it first
+                io_uring_sqe* sqe = ring.next_sqe();
+                if (!sqe && ring.submit_and_wait(0))
+                    sqe = ring.next_sqe();
+                if (!sqe)
+                    return false;
+
+                sqe->fd = reading ? in_fd : out_fd;
+                sqe->off = reading
+                               ? s.offset + s.done
+                               : s.offset / in_unit * out_unit + s.done;
+                sqe->user_data = index;
+
+                if (fixed)
+                {
+                    sqe->opcode = reading ? IORING_OP_READ_FIXED
+                                          : IORING_OP_WRITE_FIXED;
+                    sqe->addr = reinterpret_cast<std::uintptr_t>(buffer + s.done);
+                    sqe->len = static_cast<unsigned>(s.size - s.done);
+                    sqe->buf_index = static_cast<uint16_t>(
+                        index * 2 + (reading ? 0 : 1));
+                }
+                else
+                {
+                    s.vec = {buffer + s.done, s.size - s.done};
+                    sqe->opcode = reading ? IORING_OP_READV : IORING_OP_WRITEV;
+                    sqe->addr = reinterpret_cast<std::uintptr_t>(&s.vec);
+                    sqe->len = 1;
+                }
+                return true;
+            };
+
+            std::uint64_t next_read = 0;
+            unsigned in_flight = 0;
+            std::error_code failure;
+
+            // Cancels what is still in flight and reaps every completion
+            const auto drain = [&]
+            {
+                constexpr std::uint64_t cancel_tag = UINT64_MAX;
+                for (size_t i = 0; i < slots.size(); ++i)
+                {
+                    if (slots[i].current == state::idle)
+                        continue;
+
+                    // Best effort: requests that cannot be cancelled complete
+                    io_uring_sqe* sqe = ring.next_sqe();
+                    if (!sqe)
+                        break;
+                    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                    sqe->fd = -1;
+                    sqe->addr = i;
+                    sqe->user_data = cancel_tag;
+                }
+
+                while (in_flight != 0)
+                {
+                    // submit_and_wait() retries EINTR and EAGAIN itself;
+                    // give a kernel short of memory a few more chances
+                    unsigned attempts = 0;
+                    while (!ring.submit_and_wait(1))
+                    {
+                        if (errno != ENOMEM || ++attempts == 100)
+                            return false;
+                        std::this_thread::sleep_for(
+                            std::chrono::milliseconds(1));
+                    }
+
+                    ring.for_each_completion([&](const std::uint64_t index,
+                                                 const int /* result */)
+                    {
+                        if (index == cancel_tag)
+                            return;
+                        slots[index].current = state::idle;
+                        --in_flight;
+                    });
+                }
+                return true;
+            };
+
+            for (;;)
+            {
+                for (size_t i = 0; i < slots.size() && !failure &&
+                     next_read < size; ++i)
+                {
+                    if (slots[i].current != state::idle)
+                        continue;
+
+                    slots[i].current = state::reading;
+                    slots[i].offset = next_read;
+                    slots[i].size = static_cast<size_t>(std::min<std::uint64_t>(
+                        in_chunk, size - next_read));
+                    slots[i].done = 0;
+                    if (!queue(i))
+                    {
+                        slots[i].current = state::idle;
+                        failure = make_error_code(error::io_error);
+                        break;
+                    }
+                    next_read += slots[i].size;
+                    ++in_flight;
+                }
+
+                if (in_flight == 0)
+                    break;
+
+                if (!ring.submit_and_wait(1))
+                {
+                    failure = make_error_code(error::io_error);
+                    break;
+                }
+
+                ring.for_each_completion([&](const std::uint64_t index,
+                                             const int result)
+                {
+                    auto& s = slots[index];
+                    const auto requeue = [&]
+                    {
+                        if (queue(index))
+                            return;
+                        if (!failure)
+                            failure = make_error_code(error::io_error);
+                        s.current = state::idle;
+                        --in_flight;
+                    };
+
+                    if (result == -EINTR || result == -EAGAIN)
+                    {
+                        requeue();
+                        return;
+                    }
+
+                    if (result <= 0 || failure)
+                    {
+                        if (!failure)
+                            failure = make_error_code(error::io_error);
+                        s.current = state::idle;
+                        --in_flight;
+                        return;
+                    }
+
+                    s.done += static_cast<size_t>(result);
+                    if (s.done < s.size)
+                    {
+                        requeue();
+                        return;
+                    }
+
+                    if (s.current == state::writing)
+                    {
+                        s.current = state::idle;
+                        --in_flight;
+                        return;
+                    }
+
+                    const auto produced = transform(
+                        s.offset, std::span<const std::byte>(s.input.data(),
+                                                             s.size),
+                        s.output.data());
+                    if (!produced)
+                    {
+                        failure = produced.error();
+                        s.current = state::idle;
+                        --in_flight;
+                        return;
+                    }
+
+                    s.current = state::writing;
+                    s.size = *produced;
+                    s.done = 0;
+                    requeue();
+                });
+            }
+
+            if (in_flight != 0 && !drain())
+            {
+                // The kernel may still write into the buffers: leak them
+                // rather than hand the memory back to the allocator
+                static_cast<void>(new std::vector<slot>(std::move(slots)));
+            }
+
+            return failure;
+        }
+
+        /**
+         * @brief Opens both files and runs uring_transform over them.
+         *
+         * @return std::nullopt when io_uring is unavailable, so the caller can
+         *         fall back to the blocking implementation
+         */
+        template <typename Transform>
+        [[nodiscard]] std::optional<std::error_code> uring_file_transform(
+            const std::filesystem::path& input_path,
+            const std::filesystem::path& output_path,
+            const std::uintmax_t input_size,
+            const std::uintmax_t output_size,
+            const async_io_options& options,
+            const size_t in_chunk,
+            const size_t out_chunk,
+            const unsigned in_unit,
+            const unsigned out_unit,
+            Transform&& transform)
+        {
+            const unsigned depth = std::max(options.queue_depth, 1u);
+            const auto ring = io_ring::create(depth);
+            if (!ring)
+                return std::nullopt;
+
+            const unique_fd input(::open(input_path.c_str(),
+                                         O_RDONLY | O_CLOEXEC));
+            if (!input)
+                return make_error_code(error::file_not_readable);
+
+            const unique_fd output(::open(output_path.c_str(),
+                                          O_WRONLY | O_CREAT | O_CLOEXEC,
+                                          0666));
+            if (!output || !preallocate(output.get(), output_size))
+                return make_error_code(error::io_error);
+
+            return uring_transform(*ring, input.get(), output.get(),
+                                   input_size, in_chunk, out_chunk, depth,
+                                   in_unit, out_unit,
+                                   std::forward<Transform>(transform));
+        }
+    } // namespace detail
+#endif
+
+    /**
+     * @brief Reports whether the io_uring engine can run in this process.
+     *
+     * Where it cannot (non-Linux, old kernels, seccomp sandboxes) the
+     * async_io_options overloads use the blocking streaming functions.
+     */
+    [[nodiscard]] inline bool async_io_supported()
+    {
+#if BASE64_IO_URING
+        static const bool supported = detail::io_ring::create(1) != nullptr;
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Encodes a file into Base64 with io_uring, keeping several reads and writes in flight.
+     *
+     * Up to queue_depth chunks are read concurrently into registered
+     * buffers, encoded as their reads complete and written at their final
+     * offsets into the preallocated output. Where io_uring is unavailable
+     * (non-Linux, old kernels, sandboxes) the blocking streaming encoder is
+     * used instead.
+     *
+     * @param input_path Path to the input file
+     * @param output_path Path where to write the encoded result
+     * @param options Queue depth and chunk size
+     * @param chars Character set to use (default: standard Base64)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_encode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        [[maybe_unused]] const async_io_options& options,
+        const std::string_view chars = base64_chars,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return make_error_code(detail::charset_error(chars));
+
+            const auto probed = detail::input_size(input_path, max_size);
+            if (!probed)
+                return probed.error();
+
+            // Inputs without a reliable size, or too large for positional
+            // I/O on this platform, are read sequentially
+            if (!*probed || !detail::fits_positional_io(**probed))
+                return base64_encode_file_to_file(input_path, output_path,
+                                                  chars,
+                                                  detail::default_chunk_size,
+                                                  max_size);
+            const std::uintmax_t file_size = **probed;
+
+#if BASE64_IO_URING
+            const size_t chunk = std::max<size_t>(options.chunk_size / 3 * 3, 3);
+            if (const auto result = detail::uring_file_transform(
+                input_path, output_path, file_size,
+                detail::encoded_size(file_size), options, chunk,
+                detail::encoded_size(chunk), 3, 4,
+                [chars](std::uint64_t, const std::span<const std::byte> in,
+                        std::byte* out) -> std::expected<size_t, std::error_code>
+                {
+                    auto* text = reinterpret_cast<char*>(out);
+                    return static_cast<size_t>(
+                        detail::encode_into(in, text, chars) - text);
+                }))
+                return *result;
+#endif
+
+            return base64_encode_file_to_file(input_path, output_path, chars,
+                                              detail::default_chunk_size,
+                                              max_size);
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+    /**
+     * @brief Decodes a Base64-encoded file with io_uring, keeping several reads and writes in flight.
+     *
+     * The output is preallocated to the exact decoded size and every chunk
+     * is written at its final offset; only the last chunk may hold padding.
+     * Where io_uring is unavailable the blocking streaming decoder is used
+     * instead.
+     *
+     * @param input_path Path to the encoded file
+     * @param output_path Path where to write the decoded bytes
+     * @param options Queue depth and chunk size
+     * @param chars Character set to use (default: standard Base64)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_decode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        [[maybe_unused]] const async_io_options& options,
+        const std::string_view chars = base64_chars,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return make_error_code(detail::charset_error(chars));
+
+            const auto probed = detail::input_size(input_path, max_size);
+            if (!probed)
+                return probed.error();
+
+            // Inputs without a reliable size, or too large for positional
+            // I/O on this platform, are read sequentially
+            if (!*probed || !detail::fits_positional_io(**probed))
+                return base64_decode_file_to_file(input_path, output_path,
+                                                  chars,
+                                                  detail::default_chunk_size,
+                                                  max_size);
+            const std::uintmax_t file_size = **probed;
+
+            if (file_size % 4 != 0)
+                return make_error_code(error::invalid_length);
+
+#if BASE64_IO_URING
+            // The decoded size depends on the padding of the final quad
+            std::array<char, 4> last_quad{};
+            {
+                std::ifstream input(input_path, std::ios::binary);
+                input.seekg(static_cast<std::streamoff>(file_size - 4));
+                if (!input.read(last_quad.data(), 4))
+                    return make_error_code(error::io_error);
+            }
+            const std::uintmax_t decoded = file_size / 4 * 3 - 3 +
+                detail::decoded_size({last_quad.data(), 4});
+
+            const size_t chunk = std::max<size_t>(options.chunk_size / 3, 1) * 4;
+            const auto table = detail::make_decode_table(chars);
+            const std::uint64_t size = file_size;
+
+            if (const auto result = detail::uring_file_transform(
+                input_path, output_path, size, decoded, options, chunk,
+                chunk / 4 * 3, 4, 3,
+                [&table, size](const std::uint64_t offset,
+                               const std::span<const std::byte> in,
+                               std::byte* out)
+                -> std::expected<size_t, std::error_code>
+                {
+                    const auto end = detail::decode_into(
+                        {reinterpret_cast<const char*>(in.data()), in.size()},
+                        out, table, offset + in.size() == size);
+                    if (!end)
+                        return std::unexpected(
+                            make_error_code(error::invalid_character));
+                    return static_cast<size_t>(*end - out);
+                }))
+                return *result;
+#endif
+
+            return base64_decode_file_to_file(input_path, output_path, chars,
+                                              detail::default_chunk_size,
+                                              max_size);
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+    /**
+     * @brief Configuration of the page-cache bypassing (O_DIRECT) file encoder.
+     *
+     * @var chunk_size Input bytes per read, rounded down to a multiple of
+     *                 12KB so that reads and encoded writes stay 4KB aligned
+     */
+    struct direct_io_options
+    {
+        size_t chunk_size = 768 * 1024;
+    };
+
+    namespace detail
+    {
+        // Alignment satisfying O_DIRECT on 512-byte and 4KB sector devices
+        constexpr size_t direct_io_alignment = 4096;
+
+        // Smallest input chunk whose size and encoded size are both aligned
+        constexpr size_t direct_io_unit = 3 * direct_io_alignment;
+
+        /**
+         * @brief Heap buffer with a fixed size and alignment.
+         */
+        class aligned_buffer
+        {
+            struct deleter
+            {
+                size_t alignment;
+
+                void operator()(std::byte* data) const noexcept
+                {
+                    ::operator delete(data, std::align_val_t{alignment});
+                }
+            };
+
+            std::unique_ptr<std::byte, deleter> data_;
+            size_t size_;
+
+        public:
+            aligned_buffer(const size_t size, const size_t alignment)
+                : data_(static_cast<std::byte*>(::operator new(
+                            size, std::align_val_t{alignment})),
+                        deleter{alignment})
+                  , size_(size)
+            {
+            }
+
+            [[nodiscard]] std::byte* data() const noexcept
+            {
+                return data_.get();
+            }
+
+            [[nodiscard]] size_t size() const noexcept
+            {
+                return size_;
+            }
+        };
+
+        /**
+         * @brief Streaming encoder owning aligned input and output buffers.
+         *
+         * The chunk size is a multiple of direct_io_unit, so every full chunk
+         * encodes to an aligned, padding-free block; only the final partial
+         * chunk is padded.
+         */
+        class direct_stream_encoder
+        {
+            aligned_buffer input_;
+            aligned_buffer output_;
+            const std::string_view chars_;
+
+        public:
+            direct_stream_encoder(const size_t chunk_size,
+                                  const std::string_view chars)
+                : input_(chunk_size, direct_io_alignment)
+                  , output_(encoded_size(chunk_size), direct_io_alignment)
+                  , chars_(chars)
+            {
+            }
+
+            [[nodiscard]] std::span<std::byte> get_buffer() noexcept
+            {
+                return {input_.data(), input_.size()};
+            }
+
+            // Encodes the first size bytes of the buffer
+            [[nodiscard]] std::span<const char> encode(const size_t size) noexcept
+            {
+                auto* out = reinterpret_cast<char*>(output_.data());
+                const char* end = encode_into({input_.data(), size}, out,
+                                              chars_);
+                return {out, end};
+            }
+        };
+
+#if BASE64_POSIX_IO && defined(O_DIRECT)
+        /**
+         * @brief Opens path with O_DIRECT, or without it where the filesystem refuses.
+         *
+         * @return The descriptor and whether O_DIRECT is in effect
+         */
+        [[nodiscard]] inline std::pair<unique_fd, bool> open_direct(
+            const std::filesystem::path& path, const int flags)
+        {
+            unique_fd fd(::open(path.c_str(), flags | O_DIRECT | O_CLOEXEC,
+                                0666));
+            if (fd)
+                return {std::move(fd), true};
+
+            return {unique_fd(::open(path.c_str(), flags | O_CLOEXEC, 0666)),
+                    false};
+        }
+
+        // Drops a range that went through the page cache once it is on disk
+        inline void drop_cached([[maybe_unused]] const int fd,
+                                [[maybe_unused]] const off_t offset,
+                                [[maybe_unused]] const off_t size,
+                                [[maybe_unused]] const bool dirty) noexcept
+        {
+#if defined(__linux__)
+            if (dirty)
+                ::sync_file_range(fd, offset, size,
+                                  SYNC_FILE_RANGE_WAIT_BEFORE |
+                                  SYNC_FILE_RANGE_WRITE |
+                                  SYNC_FILE_RANGE_WAIT_AFTER);
+            ::posix_fadvise(fd, offset, size, POSIX_FADV_DONTNEED);
+#endif
+        }
+#endif
+    } // namespace detail
+
+    /**
+     * @brief Encodes a file into Base64 without going through the page cache.
+     *
+     * Both files are opened with O_DIRECT and transferred through 4KB
+     * aligned buffers owned by the encoder, so large jobs do not evict the
+     * working set of other processes. The unaligned final block is written
+     * after clearing O_DIRECT on the output. Filesystems that refuse
+     * O_DIRECT are read and written normally, dropping each chunk from the
+     * cache once it is done; platforms without O_DIRECT use the streaming
+     * encoder.
+     *
+     * @param input_path Path to the input file
+     * @param output_path Path where to write the encoded result
+     * @param options Chunk size
+     * @param chars Character set to use (default: standard Base64)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_encode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        [[maybe_unused]] const direct_io_options& options,
+        const std::string_view chars = base64_chars,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return make_error_code(detail::charset_error(chars));
+
+            const auto probed = detail::input_size(input_path, max_size);
+            if (!probed)
+                return probed.error();
+
+            // Inputs without a reliable size, or too large for positional
+            // I/O on this platform, are read sequentially
+            if (!*probed || !detail::fits_positional_io(**probed))
+                return base64_encode_file_to_file(input_path, output_path,
+                                                  chars,
+                                                  detail::default_chunk_size,
+                                                  max_size);
+            const std::uintmax_t file_size = **probed;
+
+#if BASE64_POSIX_IO && defined(O_DIRECT)
+            const auto [input, input_direct] = detail::open_direct(
+                input_path, O_RDONLY);
+            if (!input)
+                return make_error_code(error::file_not_readable);
+
+            const auto [output, output_direct] = detail::open_direct(
+                output_path, O_WRONLY | O_CREAT | O_TRUNC);
+            if (!output)
+                return make_error_code(error::io_error);
+
+            const size_t chunk = std::max(
+                options.chunk_size / detail::direct_io_unit *
+                detail::direct_io_unit, detail::direct_io_unit);
+            detail::direct_stream_encoder encoder(chunk, chars);
+
+            off_t in_offset = 0;
+            off_t out_offset = 0;
+            bool output_is_direct = output_direct;
+
+            for (;;)
+            {
+                const auto buffer = encoder.get_buffer();
+                ssize_t got;
+                do
+                {
+                    got = ::pread(input.get(), buffer.data(), buffer.size(),
+                                  in_offset);
+                }
+                while (got < 0 && errno == EINTR);
+
+                if (got < 0)
+                    return make_error_code(error::io_error);
+                if (got == 0)
+                    break;
+
+                // A short read mid-file would leave later reads unaligned
+                const auto read_size = static_cast<size_t>(got);
+                const bool last = read_size < buffer.size();
+                if (last && static_cast<std::uintmax_t>(in_offset + got) <
+                    file_size)
+                    return make_error_code(error::io_error);
+
+                const auto encoded = encoder.encode(read_size);
+
+                if (output_is_direct &&
+                    encoded.size() % detail::direct_io_alignment != 0)
+                {
+                    const int flags = ::fcntl(output.get(), F_GETFL);
+                    if (flags < 0 || ::fcntl(output.get(), F_SETFL,
+                                             flags & ~O_DIRECT) != 0)
+                        return make_error_code(error::io_error);
+                    output_is_direct = false;
+                }
+
+                if (!detail::write_all_at(output.get(), encoded.data(),
+                                          encoded.size(), out_offset))
+                    return make_error_code(error::io_error);
+
+                if (!input_direct)
+                    detail::drop_cached(input.get(), in_offset, got, false);
+                if (!output_direct)
+                    detail::drop_cached(output.get(), out_offset,
+                                        static_cast<off_t>(encoded.size()),
+                                        true);
+
+                in_offset += got;
+                out_offset += static_cast<off_t>(encoded.size());
+
+                if (last)
+                    break;
+            }
+
+            return {};
+#else
+            return base64_encode_file_to_file(input_path, output_path, chars,
+                                              detail::default_chunk_size,
+                                              max_size);
+#endif
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+#if BASE64_POSIX_IO
+    namespace detail
+    {
+        // Blocks until a non-blocking descriptor is ready for events
+        [[nodiscard]] inline bool wait_ready(const int fd,
+                                             const short events) noexcept
+        {
+            pollfd entry{fd, events, 0};
+            while (::poll(&entry, 1, -1) < 0)
+            {
+                if (errno != EINTR)
+                    return false;
+            }
+            return true;
+        }
+
+        // write() until everything is written or a real error occurs
+        [[nodiscard]] inline bool write_all(const int fd, const void* data,
+                                            size_t size) noexcept
+        {
+            const auto* bytes = static_cast<const char*>(data);
+            while (size != 0)
+            {
+                const ssize_t written = ::write(fd, bytes, size);
+                if (written < 0)
+                {
+                    if (errno == EINTR ||
+                        (errno == EAGAIN && wait_ready(fd, POLLOUT)))
+                        continue;
+                    return false;
+                }
+
+                bytes += written;
+                size -= static_cast<size_t>(written);
+            }
+            return true;
+        }
+
+        // read() until size bytes arrive or the input ends
+        [[nodiscard]] inline std::optional<size_t> read_full(
+            const int fd, void* data, const size_t size) noexcept
+        {
+            auto* bytes = static_cast<char*>(data);
+            size_t total = 0;
+            while (total != size)
+            {
+                const ssize_t got = ::read(fd, bytes + total, size - total);
+                if (got < 0)
+                {
+                    if (errno == EINTR ||
+                        (errno == EAGAIN && wait_ready(fd, POLLIN)))
+                        continue;
+                    return std::nullopt;
+                }
+                if (got == 0)
+                    break;
+
+                total += static_cast<size_t>(got);
+            }
+            return total;
+        }
+
+        /**
+         * @brief Output buffers for a descriptor, optionally handed to pipes with vmsplice().
+         *
+         * vmsplice() makes a pipe reference the buffer pages instead of
+         * copying them, so a buffer may only be refilled once the pipe can
+         * no longer hold it. The ring of page-aligned buffers is therefore
+         * sized to exceed the pipe capacity by at least one buffer, which
+         * only holds while the reader copies data out of the pipe and the
+         * pipe keeps its size. Other descriptors, pipes refusing vmsplice()
+         * and writers without allow_splice get plain writes.
+         */
+        class fd_writer
+        {
+            const int fd_;
+            std::vector<aligned_buffer> ring_;
+            size_t next_ = 0;
+            bool splice_ = false;
+
+        public:
+            fd_writer(const int fd, [[maybe_unused]] const struct stat& info,
+                      const size_t buffer_size,
+                      [[maybe_unused]] const bool allow_splice)
+                : fd_(fd)
+            {
+                size_t count = 1;
+                size_t alignment = alignof(std::max_align_t);
+#if defined(__linux__)
+                const int capacity = allow_splice && S_ISFIFO(info.st_mode)
+                                         ? ::fcntl(fd, F_GETPIPE_SZ)
+                                         : -1;
+                if (capacity > 0)
+                {
+                    splice_ = true;
+                    count = static_cast<size_t>(capacity) / buffer_size + 2;
+                    alignment = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+                }
+#endif
+                ring_.reserve(count);
+                for (size_t i = 0; i < count; ++i)
+                    ring_.emplace_back(buffer_size, alignment);
+            }
+
+            [[nodiscard]] std::span<char> buffer() noexcept
+            {
+                return {reinterpret_cast<char*>(ring_[next_].data()),
+                        ring_[next_].size()};
+            }
+
+            // Writes the first size bytes of buffer() and moves to the next one
+            [[nodiscard]] bool write(size_t size) noexcept
+            {
+                const char* data = buffer().data();
+                next_ = (next_ + 1) % ring_.size();
+
+#if defined(__linux__)
+                while (splice_ && size != 0)
+                {
+                    iovec pages{const_cast<char*>(data), size};
+                    const ssize_t spliced = ::vmsplice(fd_, &pages, 1, 0);
+                    if (spliced < 0)
+                    {
+                        if (errno == EINTR ||
+                            (errno == EAGAIN && wait_ready(fd_, POLLOUT)))
+                            continue;
+                        if (errno == EAGAIN || errno == EPIPE)
+                            return false;
+
+                        splice_ = false;
+                        break;
+                    }
+
+                    data += spliced;
+                    size -= static_cast<size_t>(spliced);
+                }
+#endif
+                return write_all(fd_, data, size);
+            }
+        };
+
+        /**
+         * @brief Maps a large regular file from its current offset onwards.
+         *
+         * On success the descriptor is moved to the end of the file, as if
+         * the mapped bytes had been read.
+         */
+        [[nodiscard]] inline std::optional<std::pair<mapped_file, size_t>>
+        map_remaining(const int fd, const struct stat& info)
+        {
+            if (!S_ISREG(info.st_mode) ||
+                static_cast<std::uintmax_t>(info.st_size) < mmap_threshold ||
+                !fits_positional_io(static_cast<std::uintmax_t>(info.st_size)))
+                return std::nullopt;
+
+            const off_t start = ::lseek(fd, 0, SEEK_CUR);
+            if (start < 0 || start >= info.st_size)
+                return std::nullopt;
+
+            auto mapping = mapped_file::map(fd,
+                                            static_cast<size_t>(info.st_size));
+            if (!mapping || ::lseek(fd, info.st_size, SEEK_SET) < 0)
+                return std::nullopt;
+
+            return std::pair{std::move(*mapping), static_cast<size_t>(start)};
+        }
+    } // namespace detail
+
+    /**
+     * @brief Configuration of descriptor encoding.
+     *
+     * @var chunk_size Input bytes encoded per write, rounded down to a
+     *                 multiple of 12KB, or auto_chunk_size (default: 48KB)
+     * @var vmsplice   Hand the encoded pages to an output pipe with
+     *                 vmsplice() instead of copying them (Linux). Output
+     *                 buffers are reused once a pipe capacity's worth of
+     *                 later output has been written, so only enable this
+     *                 when the consumer read()s the data out of the pipe,
+     *                 never splices or tees the pages onwards, and does
+     *                 not resize the pipe while encoding
+     */
+    struct fd_encode_options
+    {
+        size_t chunk_size = detail::default_chunk_size;
+        bool vmsplice = false;
+    };
+
+    /**
+     * @brief Encodes everything readable from a descriptor into another one.
+     *
+     * Works on files, pipes and sockets. A single fstat() per descriptor
+     * decides the strategy: large regular files are memory-mapped from the
+     * current offset, anything else is read until end of input. With
+     * options.vmsplice set and a pipe as output, the encoded pages are
+     * handed over with vmsplice() from a ring of page-aligned buffers,
+     * saving a copy into the kernel. The descriptors are not closed.
+     *
+     * @param input_fd Descriptor to read the data from
+     * @param output_fd Descriptor to write the encoded text to
+     * @param options Chunk size and vmsplice() opt-in
+     * @param chars Character set to use (default: standard Base64)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_encode_fd(
+        const int input_fd,
+        const int output_fd,
+        const fd_encode_options& options,
+        const std::string_view chars = base64_chars)
+    {
+        const size_t chunk_size = options.chunk_size;
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return make_error_code(detail::charset_error(chars));
+
+            struct stat input_info{};
+            struct stat output_info{};
+            if (::fstat(input_fd, &input_info) != 0 ||
+                ::fstat(output_fd, &output_info) != 0)
+                return make_error_code(error::io_error);
+
+            const size_t requested = chunk_size != auto_chunk_size
+                                         ? chunk_size
+                                         : detail::make_chunk_sizing(
+                                             detail::current_cache_topology(),
+                                             static_cast<size_t>(
+                                                 input_info.st_blksize))
+                                         .chunk_size;
+            const size_t chunk = std::max(
+                requested / detail::direct_io_unit * detail::direct_io_unit,
+                detail::direct_io_unit);
+            detail::fd_writer writer(output_fd, output_info,
+                                     detail::encoded_size(chunk),
+                                     options.vmsplice);
+
+            const auto encode_chunk = [&](const std::span<const std::byte> data)
+            {
+                const char* end = detail::encode_into(
+                    data, writer.buffer().data(), chars);
+                return writer.write(
+                    static_cast<size_t>(end - writer.buffer().data()));
+            };
+
+            if (const auto mapping = detail::map_remaining(input_fd,
+                                                           input_info))
+            {
+                const auto data = mapping->first.bytes().subspan(
+                    mapping->second);
+                for (size_t offset = 0; offset < data.size(); offset += chunk)
+                {
+                    if (!encode_chunk(data.subspan(
+                        offset, std::min(chunk, data.size() - offset))))
+                        return make_error_code(error::io_error);
+                }
+                return {};
+            }
+
+            std::vector<std::byte> buffer(chunk);
+            std::uintmax_t total = 0;
+            for (;;)
+            {
+                const auto got = detail::read_full(input_fd, buffer.data(),
+                                                   buffer.size());
+                if (!got)
+                    return make_error_code(error::file_not_readable);
+                if (*got == 0)
+                    break;
+
+                if (!encode_chunk({buffer.data(), *got}))
+                    return make_error_code(error::io_error);
+
+                total += *got;
+                if (*got < buffer.size())
+                    break;
+            }
+
+            if (total == 0)
+                return make_error_code(error::empty_data);
+
+            return {};
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+    /**
+     * @brief Encodes everything readable from a descriptor into another one, with plain writes.
+     *
+     * @param input_fd Descriptor to read the data from
+     * @param output_fd Descriptor to write the encoded text to
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Input bytes encoded per write, rounded down to a
+     *                   multiple of 12KB, or auto_chunk_size (default: 48KB)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_encode_fd(
+        const int input_fd,
+        const int output_fd,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size)
+    {
+        return base64_encode_fd(input_fd, output_fd,
+                                fd_encode_options{.chunk_size = chunk_size,
+                                                  .vmsplice = false},
+                                chars);
+    }
+
+    /**
+     * @brief Decodes Base64 text readable from a descriptor into another one.
+     *
+     * Works on files, pipes and sockets, using a single fstat() per
+     * descriptor; large regular files are memory-mapped from the current
+     * offset. Output written before an error is detected is not undone.
+     * The descriptors are not closed.
+     *
+     * @param input_fd Descriptor to read the encoded text from
+     * @param output_fd Descriptor to write the decoded data to
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_decode_fd(
+        const int input_fd,
+        const int output_fd,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size)
+    {
+        try
+        {
+            if (!detail::validate_charset(chars))
+                return make_error_code(detail::charset_error(chars));
+
+            struct stat input_info{};
+            if (::fstat(input_fd, &input_info) != 0)
+                return make_error_code(error::io_error);
+
+            const size_t chunk = chunk_size != auto_chunk_size
+                                     ? std::max(chunk_size, size_t{4})
+                                     : detail::make_chunk_sizing(
+                                         detail::current_cache_topology(),
+                                         static_cast<size_t>(
+                                             input_info.st_blksize))
+                                     .chunk_size;
+            detail::stream_decoder decoder(0, chars, chunk);
+
+            const auto decode_chunk = [&](const std::string_view text)
+            {
+                if (!decoder.process_chunk(text))
+                    return make_error_code(error::invalid_character);
+
+                const auto output = decoder.output();
+                if (!detail::write_all(output_fd, output.data(),
+                                       output.size()))
+                    return make_error_code(error::io_error);
+
+                decoder.clear_output();
+                return std::error_code{};
+            };
+
+            if (const auto mapping = detail::map_remaining(input_fd,
+                                                           input_info))
+            {
+                const auto data = mapping->first.bytes().subspan(
+                    mapping->second);
+                const std::string_view text(
+                    reinterpret_cast<const char*>(data.data()), data.size());
+                for (size_t offset = 0; offset < text.size(); offset += chunk)
+                {
+                    if (const auto error = decode_chunk(
+                        text.substr(offset, chunk)))
+                        return error;
+                }
+            }
+            else
+            {
+                for (;;)
+                {
+                    const auto buffer = decoder.get_buffer();
+                    const auto got = detail::read_full(input_fd,
+                                                       buffer.data(),
+                                                       buffer.size());
+                    if (!got)
+                        return make_error_code(error::file_not_readable);
+                    if (*got == 0)
+                        break;
+
+                    if (const auto error = decode_chunk(
+                        {buffer.data(), *got}))
+                        return error;
+
+                    if (*got < buffer.size())
+                        break;
+                }
+            }
+
+            const auto tail = std::move(decoder).finalize();
+            if (!tail)
+                return make_error_code(tail.error());
+
+            if (!detail::write_all(output_fd, tail->data(), tail->size()))
+                return make_error_code(error::io_error);
+
+            return {};
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+#endif
+
+    /**
+     * @brief When written outputs are flushed to stable storage.
+     *
+     * @var none Leave it to the operating system (fastest, not crash safe)
+     * @var per_file fsync() every output before it is published
+     * @var per_batch Sync once per filesystem after a whole batch with
+     *                syncfs(), then publish the outputs; where syncfs() is
+     *                unavailable every output is fsync()ed as with per_file
+     */
+    enum class sync_policy
+    {
+        none,
+        per_file,
+        per_batch
+    };
+
+    /**
+     * @brief Crash-safety of file outputs.
+     *
+     * @var atomic_rename Write to a temporary file next to the destination
+     *                    and rename it into place once complete, so readers
+     *                    and crashes never see a torn output
+     * @var sync Flushing of the written data and of the directory entries
+     */
+    struct durability_options
+    {
+        bool atomic_rename = false;
+        sync_policy sync = sync_policy::none;
+    };
+
+    namespace detail
+    {
+        // Hidden, unique sibling of target on the same filesystem
+        [[nodiscard]] inline std::filesystem::path temporary_path(
+            const std::filesystem::path& target)
+        {
+            static std::atomic<std::uint64_t> counter{0};
+            auto name = "." + target.filename().string() + ".";
+#if BASE64_POSIX_IO
+            name += std::to_string(::getpid()) + ".";
+#endif
+            name += std::to_string(counter.fetch_add(1)) + ".tmp";
+            return target.parent_path() / name;
+        }
+
+        // fsync() of a file or directory
+        [[nodiscard]] inline bool sync_path(
+            [[maybe_unused]] const std::filesystem::path& path)
+        {
+#if BASE64_POSIX_IO
+            const unique_fd fd(::open(path.empty() ? "." : path.c_str(),
+                                      O_RDONLY | O_CLOEXEC));
+            return fd && ::fsync(fd.get()) == 0;
+#else
+            return true;
+#endif
+        }
+
+#if defined(__linux__)
+        // Flushes every file of the filesystem holding path
+        [[nodiscard]] inline bool sync_filesystem(
+            const std::filesystem::path& path)
+        {
+            const unique_fd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+            return fd && ::syncfs(fd.get()) == 0;
+        }
+
+        constexpr bool has_sync_filesystem = true;
+#else
+        // sync() neither reports errors nor waits everywhere: fsync() instead
+        constexpr bool has_sync_filesystem = false;
+#endif
+
+        [[nodiscard]] inline std::filesystem::path parent_directory(
+            const std::filesystem::path& path)
+        {
+            return path.has_parent_path() ? path.parent_path() : ".";
+        }
+
+        /**
+         * @brief Syncs and publishes the outputs of jobs written to staged paths.
+         *
+         * Jobs with an error have their staged file removed. Outputs are
+         * renamed only after their data is durable, and the directories
+         * are synced last so that the new entries survive a crash too.
+         * A failed sync fails every job it covered: all jobs on the
+         * filesystem for syncfs(), all jobs published in the directory for
+         * a directory fsync() (their outputs are in place but may not
+         * survive a crash).
+         */
+        inline void commit_outputs(
+            const std::span<const std::filesystem::path> staged,
+            const std::span<const std::filesystem::path> targets,
+            const std::span<std::error_code> errors,
+            const durability_options& durability)
+        {
+#if defined(__linux__)
+            if (durability.sync == sync_policy::per_batch)
+            {
+                std::vector<dev_t> devices(staged.size());
+                for (size_t i = 0; i < staged.size(); ++i)
+                {
+                    struct stat info{};
+                    if (errors[i])
+                        continue;
+                    if (::stat(staged[i].c_str(), &info) != 0)
+                        errors[i] = make_error_code(error::io_error);
+                    devices[i] = info.st_dev;
+                }
+
+                std::vector<dev_t> synced;
+                for (size_t i = 0; i < staged.size(); ++i)
+                {
+                    if (errors[i] || std::ranges::find(synced, devices[i]) !=
+                        synced.end())
+                        continue;
+                    synced.push_back(devices[i]);
+
+                    if (!sync_filesystem(staged[i]))
+                        for (size_t j = i; j < staged.size(); ++j)
+                            if (!errors[j] && devices[j] == devices[i])
+                                errors[j] = make_error_code(error::io_error);
+                }
+            }
+#endif
+
+            const bool sync_each = durability.sync == sync_policy::per_file ||
+                (durability.sync == sync_policy::per_batch &&
+                    !has_sync_filesystem);
+
+            // Published directories and the jobs that depend on each
+            std::vector<std::pair<std::filesystem::path, std::vector<size_t>>>
+                directories;
+            for (size_t i = 0; i < staged.size(); ++i)
+            {
+                std::error_code ec;
+                if (!errors[i] && sync_each && !sync_path(staged[i]))
+                    errors[i] = make_error_code(error::io_error);
+
+                if (errors[i])
+                {
+                    if (staged[i] != targets[i])
+                        std::filesystem::remove(staged[i], ec);
+                    continue;
+                }
+
+                if (staged[i] != targets[i])
+                {
+                    std::filesystem::rename(staged[i], targets[i], ec);
+                    if (ec)
+                    {
+                        errors[i] = make_error_code(error::io_error);
+                        std::filesystem::remove(staged[i], ec);
+                        continue;
+                    }
+                }
+
+                if (durability.sync != sync_policy::none)
+                {
+                    auto directory = parent_directory(targets[i]);
+                    const auto found = std::ranges::find(
+                        directories, directory,
+                        &decltype(directories)::value_type::first);
+                    if (found != directories.end())
+                        found->second.push_back(i);
+                    else
+                        directories.emplace_back(std::move(directory),
+                                                 std::vector<size_t>{i});
+                }
+            }
+
+            for (const auto& [directory, jobs] : directories)
+                if (!sync_path(directory))
+                    for (const size_t i : jobs)
+                        errors[i] = make_error_code(error::io_error);
+        }
+    } // namespace detail
+
+    /**
+     * @brief Encodes a file into Base64 and writes it to an output file with
+     * the given crash-safety.
+     *
+     * With atomic_rename the destination keeps its previous content until
+     * the new encoding is complete (and synced, unless sync is none).
+     *
+     * @param input_path Path to the input file
+     * @param output_path Path where to write the encoded result
+     * @param durability Temporary file and sync policy
+     * @param chars Character set to use (default: standard Base64)
+     * @param chunk_size Size of chunks to read, or auto_chunk_size (default: 48KB)
+     * @param max_size Maximum file size to process (default: no limit)
+     * @return std::error_code Error code (empty if successful)
+     */
+    [[nodiscard]] inline std::error_code base64_encode_file_to_file(
+        const std::filesystem::path& input_path,
+        const std::filesystem::path& output_path,
+        const durability_options& durability,
+        const std::string_view chars = base64_chars,
+        const size_t chunk_size = detail::default_chunk_size,
+        const std::uintmax_t max_size = no_size_limit)
+    {
+        try
+        {
+            const std::filesystem::path staged = durability.atomic_rename
+                                                     ? detail::temporary_path(
+                                                         output_path)
+                                                     : output_path;
+            std::error_code error = base64_encode_file_to_file(
+                input_path, staged, chars, chunk_size, max_size);
+
+            detail::commit_outputs({&staged, 1}, {&output_path, 1},
+                                   {&error, 1}, durability);
+            return error;
+        }
+        catch (const std::exception&)
+        {
+            return make_error_code(error::io_error);
+        }
+    }
+
+    /**
+     * @brief An input file and the path its encoding is written to.
+     */
+    struct file_job
+    {
+        std::filesystem::path input;
+        std::filesystem::path output;
+    };
+
+    /**
+     * @brief Outcome of one file of a directory batch.
+     */
+    struct file_job_result
+    {
+        file_job job;
+        std::error_code error;
+    };
+
+    /**
+     * @brief Scheduling of batch file encoding.
+     *
+     * @var group_bytes Input bytes of small files grouped into one task
+     * @var split_bytes Files of at least this size are encoded as pieces of
+     *                  about this size in parallel, into a preallocated output
+     * @var max_size Maximum size of each input file
+     * @var durability Temporary files and syncing of the outputs; with
+     *                 sync_policy::per_batch all outputs are synced together
+     *                 before any of them is published
+     */
+    struct file_batch_options
+    {
+        size_t group_bytes = 1024 * 1024;
+        size_t split_bytes = 8 * 1024 * 1024;
+        std::uintmax_t max_size = no_size_limit;
+        durability_options durability{};
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Encodes a whole small file with one read and one write.
+         *
+         * The buffers are reused for all files of a task.
+         */
+        [[nodiscard]] inline std::error_code encode_whole_file(
+            const file_job& job, const std::uintmax_t size,
+            const std::string_view chars, std::vector<std::byte>& input,
+            std::string& output)
+        {
+#if BASE64_POSIX_IO
+            const unique_fd in(::open(job.input.c_str(), O_RDONLY | O_CLOEXEC));
+            if (!in)
+                return make_error_code(error::file_not_readable);
+
+            input.resize(static_cast<size_t>(size));
+            const auto got = read_full(in.get(), input.data(), input.size());
+            if (!got || *got != input.size())
+                return make_error_code(error::io_error);
+
+            output.resize(encoded_size(input.size()));
+            encode_into(input, output.data(), chars);
+
+            const unique_fd out(::open(job.output.c_str(),
+                                       O_WRONLY | O_CREAT | O_TRUNC |
+                                       O_CLOEXEC, 0666));
+            if (!out || !write_all(out.get(), output.data(), output.size()))
+                return make_error_code(error::io_error);
+
+            return {};
+#else
+            return base64_encode_file_to_file(job.input, job.output, chars,
+                                              default_chunk_size, size);
+#endif
+        }
+
+#if BASE64_POSIX_IO
+        /**
+         * @brief A large file of a batch, shared by the tasks encoding its pieces.
+         *
+         * The first piece to run opens both files and the last one to finish
+         * closes them, so a batch only holds descriptors for the files in
+         * progress rather than for every large file it contains.
+         */
+        struct split_file
+        {
+            size_t job;
+            std::uintmax_t size;
+            std::atomic<size_t> remaining;
+            std::once_flag opened;
+            unique_fd input;
+            unique_fd output;
+            std::error_code open_error;
+
+            split_file(const size_t job, const std::uintmax_t size,
+                       const size_t pieces)
+                : job(job)
+                  , size(size)
+                  , remaining(pieces)
+            {
+            }
+
+            void open(const file_job& paths)
+            {
+                input = unique_fd(::open(paths.input.c_str(),
+                                         O_RDONLY | O_CLOEXEC));
+                output = unique_fd(::open(paths.output.c_str(),
+                                          O_WRONLY | O_CREAT | O_CLOEXEC,
+                                          0666));
+                if (!input)
+                    open_error = make_error_code(error::file_not_readable);
+                else if (!output || !preallocate(output.get(),
+                                                 encoded_size(size)))
+                    open_error = make_error_code(error::io_error);
+            }
+
+            void piece_done() noexcept
+            {
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    input.reset();
+                    output.reset();
+                }
+            }
+        };
+
+        struct split_piece
+        {
+            split_file* file;
+            std::uintmax_t offset;
+            std::uintmax_t size;
+        };
+
+        // Encodes one 3-byte aligned range of a split file
+        [[nodiscard]] inline bool encode_piece(const split_piece& piece,
+                                               const std::string_view chars,
+                                               std::vector<std::byte>& input,
+                                               std::string& output)
+        {
+            input.resize(default_chunk_size);
+            output.resize(encoded_size(default_chunk_size));
+
+            for (std::uintmax_t done = 0; done < piece.size;)
+            {
+                const auto size = static_cast<size_t>(std::min<std::uintmax_t>(
+                    default_chunk_size, piece.size - done));
+                const auto offset = piece.offset + done;
+
+                size_t got = 0;
+                while (got < size)
+                {
+                    const ssize_t read = ::pread(
+                        piece.file->input.get(), input.data() + got,
+                        size - got, static_cast<off_t>(offset + got));
+                    if (read < 0 && errno == EINTR)
+                        continue;
+                    if (read <= 0)
+                        return false;
+                    got += static_cast<size_t>(read);
+                }
+
+                const char* end = encode_into({input.data(), size},
+                                              output.data(), chars);
+                if (!write_all_at(piece.file->output.get(), output.data(),
+                                  static_cast<size_t>(end - output.data()),
+                                  static_cast<off_t>(offset / 3 * 4)))
+                    return false;
+
+                done += size;
+            }
+            return true;
+        }
+#endif
+    } // namespace detail
+
+    /**
+     * @brief Encodes many files on a thread pool.
+     *
+     * Each input is stat'ed once up front. Small files are grouped into
+     * tasks of about group_bytes and encoded with a single read and write
+     * each, reusing the task's buffers across files. Files of split_bytes
+     * and more get a preallocated output and are encoded as pieces by
+     * several workers, which open the file on its first piece and close it
+     * after its last; pieces reuse per-thread buffers. Inputs without a
+     * reliable size, and large ones that positional I/O cannot address,
+     * are streamed. A failing file does not stop the batch. May be called
+     * from a task of the same pool.
+     *
+     * @param pool Pool that runs the tasks
+     * @param jobs Input and output paths
+     * @param chars Character set to use (default: standard Base64)
+     * @param options Grouping and splitting thresholds
+     * @return One std::error_code per job, in job order (empty if successful)
+     */
+    [[nodiscard]] inline std::vector<std::error_code> base64_encode_files(
+        thread_pool& pool,
+        const std::span<const file_job> jobs,
+        const std::string_view chars = base64_chars,
+        const file_batch_options& options = {})
+    {
+        std::vector<std::error_code> errors(jobs.size());
+        if (!detail::validate_charset(chars))
+        {
+            std::ranges::fill(errors,
+                              make_error_code(detail::charset_error(chars)));
+            return errors;
+        }
+
+        const auto& durability = options.durability;
+        if (durability.atomic_rename || durability.sync != sync_policy::none)
+        {
+            std::vector<file_job> staged_jobs(jobs.begin(), jobs.end());
+            std::vector<std::filesystem::path> staged;
+            std::vector<std::filesystem::path> targets;
+            for (auto& job : staged_jobs)
+            {
+                targets.push_back(job.output);
+                if (durability.atomic_rename)
+                    job.output = detail::temporary_path(job.output);
+                staged.push_back(job.output);
+            }
+
+            auto plain = options;
+            plain.durability = {};
+            errors = base64_encode_files(pool, staged_jobs, chars, plain);
+            detail::commit_outputs(staged, targets, errors, durability);
+            return errors;
+        }
+
+        // Files encoded by one task, with their size (0 when unknown);
+        // size-less files and those of split_bytes and more are streamed
+        std::vector<std::pair<size_t, std::uintmax_t>> whole;
+#if BASE64_POSIX_IO
+        std::deque<detail::split_file> split;
+        std::vector<detail::split_piece> pieces;
+        const std::uintmax_t piece_bytes = std::max(
+            options.split_bytes / detail::default_chunk_size *
+            detail::default_chunk_size, detail::default_chunk_size);
+#endif
+
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            const auto size = detail::input_size(jobs[i].input,
+                                                 options.max_size);
+            if (!size)
+            {
+                errors[i] = size.error();
+                continue;
+            }
+
+#if BASE64_POSIX_IO
+            if (*size && **size >= options.split_bytes &&
+                detail::fits_positional_io(**size))
+            {
+                auto& file = split.emplace_back(
+                    i, **size,
+                    static_cast<size_t>((**size + piece_bytes - 1) /
+                        piece_bytes));
+                for (std::uintmax_t offset = 0; offset < **size;
+                     offset += piece_bytes)
+                    pieces.push_back({
+                        &file, offset, std::min(piece_bytes, **size - offset)
+                    });
+                continue;
+            }
+#endif
+            whole.emplace_back(i, size->value_or(0));
+        }
+
+        std::vector<std::pair<size_t, size_t>> groups;
+        for (size_t first = 0; first < whole.size();)
+        {
+            size_t last = first;
+            std::uintmax_t bytes = 0;
+            while (last < whole.size() && (last == first || bytes <
+                options.group_bytes))
+                bytes += whole[last++].second;
+            groups.emplace_back(first, last);
+            first = last;
+        }
+
+        size_t task_count = groups.size();
+#if BASE64_POSIX_IO
+        task_count += pieces.size();
+        std::mutex piece_mutex;
+#endif
+        std::latch done(static_cast<std::ptrdiff_t>(task_count));
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+
+        const auto run = [&](auto&& work)
+        {
+            auto task = [&, work = std::forward<decltype(work)>(work)]
+            {
+                try
+                {
+                    work();
+                }
+                catch (...)
+                {
+                    std::scoped_lock lock(failure_mutex);
+                    if (!failure)
+                        failure = std::current_exception();
+                }
+                done.count_down();
+            };
+
+            if (!pool.submit(task))
+                task();
+        };
+
+        for (const auto& [first, last] : groups)
+        {
+            run([&, first, last]
+            {
+                std::vector<std::byte> input;
+                std::string output;
+                for (size_t i = first; i < last; ++i)
+                {
+                    const auto& [job, size] = whole[i];
+                    errors[job] = size != 0 && size < options.split_bytes
+                                      ? detail::encode_whole_file(
+                                          jobs[job], size, chars, input,
+                                          output)
+                                      : base64_encode_file_to_file(
+                                          jobs[job].input, jobs[job].output,
+                                          chars, detail::default_chunk_size,
+                                          options.max_size);
+                }
+            });
+        }
+
+#if BASE64_POSIX_IO
+        for (const auto& piece : pieces)
+        {
+            run([&, piece]
+            {
+                auto& file = *piece.file;
+                std::call_once(file.opened, [&] { file.open(jobs[file.job]); });
+
+                std::error_code error = file.open_error;
+                if (!error)
+                {
+                    // Reused by every piece this worker encodes
+                    thread_local std::vector<std::byte> input;
+                    thread_local std::string output;
+                    if (!detail::encode_piece(piece, chars, input, output))
+                        error = make_error_code(error::io_error);
+                }
+                file.piece_done();
+
+                if (error)
+                {
+                    std::scoped_lock lock(piece_mutex);
+                    errors[file.job] = error;
+                }
+            });
+        }
+#endif
+
+        pool.wait(done);
+        if (failure)
+            std::rethrow_exception(failure);
+
+        return errors;
+    }
+
+    /**
+     * @brief Encodes many files on the default_thread_pool().
+     */
+    [[nodiscard]] inline std::vector<std::error_code> base64_encode_files(
+        const std::span<const file_job> jobs,
+        const std::string_view chars = base64_chars,
+        const file_batch_options& options = {})
+    {
+        return base64_encode_files(default_thread_pool(), jobs, chars,
+                                   options);
+    }
+
+    /**
+     * @brief Encodes every regular file below a directory on a thread pool.
+     *
+     * The tree is mirrored below output_dir, each output named after its
+     * input plus suffix. Scheduling is as for base64_encode_files().
+     *
+     * @param pool Pool that runs the tasks
+     * @param input_dir Directory to encode recursively
+     * @param output_dir Directory receiving the encoded files
+     * @param suffix Appended to every output file name (default: ".b64")
+     * @param chars Character set to use (default: standard Base64)
+     * @param options Grouping and splitting thresholds
+     * @return The result of every file found, or the error walking the tree
+     */
+    [[nodiscard]] inline std::expected<std::vector<file_job_result>,
+                                       std::error_code>
+    base64_encode_directory(
+        thread_pool& pool,
+        const std::filesystem::path& input_dir,
+        const std::filesystem::path& output_dir,
+        const std::string_view suffix = ".b64",
+        const std::string_view chars = base64_chars,
+        const file_batch_options& options = {})
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(input_dir, ec))
+            return std::unexpected(make_error_code(error::file_not_found));
+
+        std::vector<file_job> jobs;
+        std::filesystem::path created;
+        for (std::filesystem::recursive_directory_iterator it(input_dir, ec),
+             end; !ec && it != end; it.increment(ec))
+        {
+            if (std::error_code entry_ec; !it->is_regular_file(entry_ec))
+                continue;
+
+            auto output = output_dir / it->path().lexically_relative(
+                input_dir);
+            output += suffix;
+
+            // Consecutive entries mostly share their directory
+            if (output.parent_path() != created)
+            {
+                created = output.parent_path();
+                std::filesystem::create_directories(created, ec);
+                if (ec)
+                    return std::unexpected(make_error_code(error::io_error));
+            }
+
+            jobs.push_back({it->path(), std::move(output)});
+        }
+
+        if (ec)
+            return std::unexpected(make_error_code(error::io_error));
+
+        const auto errors = base64_encode_files(pool, jobs, chars, options);
+
+        std::vector<file_job_result> results;
+        results.reserve(jobs.size());
+        for (size_t i = 0; i < jobs.size(); ++i)
+            results.push_back({std::move(jobs[i]), errors[i]});
+
+        return results;
+    }
+
+    /**
+     * @brief Encodes every regular file below a directory on the default_thread_pool().
+     */
+    [[nodiscard]] inline std::expected<std::vector<file_job_result>,
+                                       std::error_code>
+    base64_encode_directory(
+        const std::filesystem::path& input_dir,
+        const std::filesystem::path& output_dir,
+        const std::string_view suffix = ".b64",
+        const std::string_view chars = base64_chars,
+        const file_batch_options& options = {})
+    {
+        return base64_encode_directory(default_thread_pool(), input_dir,
+                                       output_dir, suffix, chars, options);
+    }
+
+    /**
+     * @brief Shared, immutable encoding handed out by the caches.
+     */
+    using shared_encode_result =
+    std::expected<std::shared_ptr<const std::string>, std::error_code>;
+
+    /**
+     * @brief Counters of an encode cache.
+     */
+    struct cache_stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Map with least-recently-used eviction under a byte budget.
+         *
+         * Not synchronized; entries larger than the budget are not stored.
+         */
+        template <typename Key, typename Value, typename Hash = std::hash<Key>>
+        class lru_map
+        {
+            struct node
+            {
+                Key key;
+                Value value;
+                size_t bytes;
+            };
+
+            // Most recently used first
+            std::list<node> order_;
+            std::unordered_map<Key, typename std::list<node>::iterator, Hash>
+            index_;
+            size_t budget_;
+            size_t bytes_ = 0;
+            std::uint64_t evictions_ = 0;
+
+            void erase(const typename std::list<node>::iterator it)
+            {
+                bytes_ -= it->bytes;
+                index_.erase(it->key);
+                order_.erase(it);
+            }
+
+        public:
+            explicit lru_map(const size_t budget) noexcept
+                : budget_(budget)
+            {
+            }
+
+            // Returns the value and marks it as most recently used
+            [[nodiscard]] Value* find(const Key& key)
+            {
+                const auto it = index_.find(key);
+                if (it == index_.end())
+                    return nullptr;
+
+                order_.splice(order_.begin(), order_, it->second);
+                return &it->second->value;
+            }
+
+            void insert(Key key, Value value, const size_t bytes)
+            {
+                if (const auto it = index_.find(key); it != index_.end())
+                    erase(it->second);
+                if (bytes > budget_)
+                    return;
+
+                while (bytes_ + bytes > budget_)
+                {
+                    erase(std::prev(order_.end()));
+                    ++evictions_;
+                }
+
+                order_.push_front({std::move(key), std::move(value), bytes});
+                index_.emplace(order_.front().key, order_.begin());
+                bytes_ += bytes;
+            }
+
+            void clear() noexcept
+            {
+                index_.clear();
+                order_.clear();
+                bytes_ = 0;
+            }
+
+            [[nodiscard]] size_t size() const noexcept
+            {
+                return index_.size();
+            }
+
+            [[nodiscard]] size_t bytes() const noexcept
+            {
+                return bytes_;
+            }
+
+            [[nodiscard]] std::uint64_t evictions() const noexcept
+            {
+                return evictions_;
+            }
+        };
+
+        // What identifies a file's content without reading it
+        struct file_identity
+        {
+            std::uint64_t device = 0;
+            std::uint64_t inode = 0;
+            std::uintmax_t size = 0;
+            std::int64_t mtime_ns = 0;
+
+            bool operator==(const file_identity&) const = default;
+        };
+
+        struct file_identity_hash
+        {
+            [[nodiscard]] size_t operator()(const file_identity& id) const
+                noexcept
+            {
+                std::uint64_t hash = id.device * 0x9E3779B97F4A7C15ull;
+                for (const std::uint64_t part : {
+                         id.inode, static_cast<std::uint64_t>(id.size),
+                         static_cast<std::uint64_t>(id.mtime_ns)
+                     })
+                    hash = (hash ^ part) * 0x100000001B3ull + (hash >> 29);
+                return static_cast<size_t>(hash);
+            }
+        };
+
+        [[nodiscard]] inline std::expected<file_identity, std::error_code>
+        identify_file(const std::filesystem::path& path)
+        {
+#if BASE64_POSIX_IO
+            struct stat info{};
+            if (::stat(path.c_str(), &info) != 0)
+                return std::unexpected(make_error_code(
+                    errno == ENOENT ? error::file_not_found : error::io_error));
+#if defined(__APPLE__)
+            const auto& mtime = info.st_mtimespec;
+#else
+            const auto& mtime = info.st_mtim;
+#endif
+            return file_identity{
+                static_cast<std::uint64_t>(info.st_dev),
+                static_cast<std::uint64_t>(info.st_ino),
+                static_cast<std::uintmax_t>(info.st_size),
+                static_cast<std::int64_t>(mtime.tv_sec) * 1000000000 +
+                mtime.tv_nsec
+            };
+#else
+            std::error_code ec;
+            const auto canonical = std::filesystem::canonical(path, ec);
+            const auto size = std::filesystem::file_size(canonical, ec);
+            const auto mtime = std::filesystem::last_write_time(canonical, ec);
+            if (ec)
+                return std::unexpected(make_error_code(
+                    std::filesystem::exists(path)
+                        ? error::io_error
+                        : error::file_not_found));
+
+            return file_identity{
+                0, std::hash<std::filesystem::path::string_type>{}(
+                    canonical.native()),
+                size, static_cast<std::int64_t>(
+                    mtime.time_since_epoch().count())
+            };
+#endif
+        }
+    } // namespace detail
+
+    /**
+     * @brief Thread-safe cache of file encodings keyed by file identity.
+     *
+     * Entries are keyed by (device, inode, size, mtime), so a repeated
+     * request for an unchanged file costs a stat and a lookup instead of a
+     * read and encode, while any rewrite of the file is picked up. Results
+     * are shared immutable strings; entries are evicted least recently
+     * used first once the byte budget is exceeded. A rewrite that keeps
+     * both size and mtime (within the filesystem's timestamp granularity)
+     * is not detected.
+     */
+    class file_encode_cache
+    {
+        mutable std::mutex mutex_;
+        detail::lru_map<detail::file_identity,
+                        std::shared_ptr<const std::string>,
+                        detail::file_identity_hash> entries_;
+        const std::string chars_;
+        std::atomic<std::uint64_t> hits_{0};
+        std::atomic<std::uint64_t> misses_{0};
+
+    public:
+        /**
+         * @param budget Maximum total size of cached encodings in bytes
+         *               (default: 64MB)
+         * @param chars Character set to use (default: standard Base64); it
+         *              is copied, so it need not outlive the cache
+         */
+        explicit file_encode_cache(const size_t budget = 64 * 1024 * 1024,
+                                   const std::string_view chars = base64_chars)
+            : entries_(budget)
+              , chars_(chars)
+        {
+        }
+
+        /**
+         * @brief Returns the encoding of a file, from the cache if it is unchanged.
+         *
+         * @param path Path to the file to encode
+         * @return shared_encode_result Shared encoded string or error
+         */
+        [[nodiscard]] shared_encode_result encode(
+            const std::filesystem::path& path)
+        {
+            const auto identity = detail::identify_file(path);
+            if (!identity)
+                return std::unexpected(identity.error());
+
+            {
+                std::scoped_lock lock(mutex_);
+                if (const auto* hit = entries_.find(*identity))
+                {
+                    hits_.fetch_add(1, std::memory_order_relaxed);
+                    return *hit;
+                }
+            }
+            misses_.fetch_add(1, std::memory_order_relaxed);
+
+            auto encoded = base64_encode_file(path, chars_);
+            if (!encoded)
+                return std::unexpected(encoded.error());
+
+            auto shared = std::make_shared<const std::string>(
+                std::move(*encoded));
+
+            // Only keep results of files that did not change while read
+            if (const auto after = detail::identify_file(path);
+                after && *after == *identity)
+            {
+                std::scoped_lock lock(mutex_);
+                entries_.insert(*identity, shared, shared->size());
+            }
+
+            return shared;
+        }
+
+        [[nodiscard]] cache_stats stats() const
+        {
+            std::scoped_lock lock(mutex_);
+            return {
+                hits_.load(std::memory_order_relaxed),
+                misses_.load(std::memory_order_relaxed),
+                entries_.evictions(), entries_.size(), entries_.bytes()
+            };
+        }
+
+        void clear()
+        {
+            std::scoped_lock lock(mutex_);
+            entries_.clear();
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Fast non-cryptographic 64-bit hash, consuming 8 bytes per step.
+         */
+        [[nodiscard]] inline std::uint64_t hash_bytes(
+            const std::span<const std::byte> data) noexcept
+        {
+            constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+            std::uint64_t hash = data.size() * multiplier;
+
+            const auto mix = [&hash](const std::uint64_t word)
+            {
+                hash = std::rotl(hash ^ (word * multiplier), 31) *
+                    0xBF58476D1CE4E5B9ull;
+            };
+
+            size_t offset = 0;
+            for (; offset + 8 <= data.size(); offset += 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, data.data() + offset, 8);
+                mix(word);
+            }
+            if (offset != data.size())
+            {
+                std::uint64_t word = 0;
+                std::memcpy(&word, data.data() + offset, data.size() - offset);
+                mix(word);
+            }
+
+            // Final avalanche (MurmurHash3 fmix64)
+            hash ^= hash >> 33;
+            hash *= 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 33;
+            hash *= 0xC4CEB9FE1A85EC53ull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Thread-safe memoizing front end for encoding hot in-memory payloads.
+     *
+     * Inputs are hashed with a fast non-cryptographic hash and looked up
+     * in one of several independently locked shards, so concurrent callers
+     * rarely contend. A hit is verified against a stored copy of the input
+     * before the shared encoding is returned, so collisions cannot return
+     * a wrong result. Each shard evicts least recently used entries once
+     * its part of the byte budget, counting input copy and encoding, is
+     * exceeded; payloads larger than a shard's budget are not memoized.
+     */
+    class encode_memo
+    {
+    public:
+        using hash_function = std::uint64_t (*)(std::span<const std::byte>);
+
+    private:
+        struct entry
+        {
+            std::vector<std::byte> input;
+            std::shared_ptr<const std::string> encoded;
+        };
+
+        struct memo_shard
+        {
+            mutable std::mutex mutex;
+            detail::lru_map<std::uint64_t, entry> entries;
+
+            explicit memo_shard(const size_t budget)
+                : entries(budget)
+            {
+            }
+        };
+
+        std::deque<memo_shard> shards_;
+        const std::string chars_;
+        const hash_function hash_;
+        std::atomic<std::uint64_t> hits_{0};
+        std::atomic<std::uint64_t> misses_{0};
+
+    public:
+        /**
+         * @param budget Maximum total bytes of memoized inputs and encodings
+         *               (default: 16MB)
+         * @param shards Number of independently locked shards (0 = hardware
+         *               concurrency)
+         * @param chars Character set to use (default: standard Base64); it
+         *              is copied, so it need not outlive the memo
+         * @param hash Hash of the inputs (default: detail::hash_bytes)
+         */
+        explicit encode_memo(const size_t budget = 16 * 1024 * 1024,
+                             unsigned shards = 0,
+                             const std::string_view chars = base64_chars,
+                             const hash_function hash = detail::hash_bytes)
+            : chars_(chars)
+              , hash_(hash)
+        {
+            if (shards == 0)
+                shards = std::max(std::thread::hardware_concurrency(), 1u);
+            for (unsigned i = 0; i < shards; ++i)
+                shards_.emplace_back(budget / shards);
+        }
+
+        /**
+         * @brief Encodes input, or returns the memoized encoding of equal input.
+         *
+         * @param input Data to encode
+         * @return shared_encode_result Shared encoded string or error
+         */
+        [[nodiscard]] shared_encode_result encode(
+            const std::span<const std::byte> input)
+        {
+            const std::uint64_t hash = hash_(input);
+            auto& target = shards_[hash % shards_.size()];
+
+            {
+                std::scoped_lock lock(target.mutex);
+                if (const auto* hit = target.entries.find(hash);
+                    hit && std::ranges::equal(hit->input, input))
+                {
+                    hits_.fetch_add(1, std::memory_order_relaxed);
+                    return hit->encoded;
+                }
+            }
+            misses_.fetch_add(1, std::memory_order_relaxed);
+
+            auto encoded = base64_encode(input, chars_);
+            if (!encoded)
+                return std::unexpected(encoded.error());
+
+            auto shared = std::make_shared<const std::string>(
+                std::move(*encoded));
+            const size_t bytes = input.size() + shared->size();
+
+            std::scoped_lock lock(target.mutex);
+            target.entries.insert(hash, entry{
+                                     {input.begin(), input.end()}, shared
+                                 }, bytes);
+            return shared;
+        }
+
+        [[nodiscard]] cache_stats stats() const
+        {
+            cache_stats stats{
+                hits_.load(std::memory_order_relaxed),
+                misses_.load(std::memory_order_relaxed)
+            };
+            for (const auto& part : shards_)
+            {
+                std::scoped_lock lock(part.mutex);
+                stats.evictions += part.entries.evictions();
+                stats.entries += part.entries.size();
+                stats.bytes += part.entries.bytes();
+            }
+            return stats;
+        }
+
+        void clear()
+        {
+            for (auto& part : shards_)
+            {
+                std::scoped_lock lock(part.mutex);
+                part.entries.clear();
+            }
+        }
+    };
 } // namespace base64
 
 // Enable automatic conversion to std::error_code
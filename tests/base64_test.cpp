@@ -100,6 +100,255 @@ TEST_SUITE("Base64 Encoding and Decoding")
         }
     }
 
+    TEST_CASE("Padding only allowed in the final quad")
+    {
+        auto result = base64::base64_decode("QQ==QQ==");
+        CHECK(!result.has_value());
+        CHECK(result.error() == base64::error::invalid_character);
+
+        result = base64::base64_decode("QQ=A");
+        CHECK(!result.has_value());
+        CHECK(result.error() == base64::error::invalid_character);
+    }
+
+    TEST_CASE("Sink-based encoding and decoding")
+    {
+        // Spans several sink blocks and ends in a partial triple
+        const auto data = make_pattern(10000 + 2, 7);
+
+        const auto expected = base64::base64_encode(data);
+        REQUIRE(expected.has_value());
+
+        std::string streamed;
+        size_t blocks = 0;
+        auto error = base64::base64_encode(
+            data,
+            [&](const std::string_view block)
+            {
+                CHECK(block.size() <= 4096);
+                streamed += block;
+                ++blocks;
+            });
+        CHECK(!error);
+        CHECK(blocks > 1);
+        CHECK(streamed == *expected);
+
+        std::string iterated;
+        auto end = base64::base64_encode(data, std::back_inserter(iterated));
+        REQUIRE(end.has_value());
+        CHECK(iterated == *expected);
+
+        std::vector<std::byte> decoded;
+        error = base64::base64_decode(
+            *expected,
+            [&](const std::span<const std::byte> block)
+            {
+                decoded.insert(decoded.end(), block.begin(), block.end());
+            });
+        CHECK(!error);
+        CHECK(decoded == data);
+
+        std::vector<std::byte> decoded_iter;
+        auto decoded_end = base64::base64_decode(
+            *expected, std::back_inserter(decoded_iter));
+        REQUIRE(decoded_end.has_value());
+        CHECK(decoded_iter == data);
+
+        error = base64::base64_decode("SGVs!G8=",
+                                      [](std::span<const std::byte>)
+                                      {
+                                      });
+        CHECK(error == base64::error::invalid_character);
+    }
+
+    TEST_CASE("Parallel encoding and decoding")
+    {
+        // Odd length so the final worker handles a padded tail
+        const auto data = make_pattern(3 * 1024 * 1024 + 1, 31);
+
+        const auto expected = base64::base64_encode(data);
+        REQUIRE(expected.has_value());
+
+        for (const unsigned threads : {1u, 3u, 8u})
+        {
+            const base64::parallel_options options{threads, 0};
+
+            auto encoded = base64::base64_encode(data, options);
+            REQUIRE(encoded.has_value());
+            CHECK(*encoded == *expected);
+
+            auto decoded = base64::base64_decode(*encoded, options);
+            REQUIRE(decoded.has_value());
+            CHECK(*decoded == data);
+        }
+
+        // Corruption in a slice other than the last is still detected
+        std::string corrupted = *expected;
+        corrupted[100] = '!';
+        auto decoded = base64::base64_decode(corrupted,
+                                             base64::parallel_options{4, 0});
+        CHECK(!decoded.has_value());
+        CHECK(decoded.error() == base64::error::invalid_character);
+
+        // Small inputs stay on the calling thread and produce the same result
+        auto small = base64::base64_encode(string_to_bytes("Hello, World!"),
+                                           base64::parallel_options{});
+        REQUIRE(small.has_value());
+        CHECK(*small == "SGVsbG8sIFdvcmxkIQ==");
+    }
+
+#if defined(__cpp_lib_execution)
+    TEST_CASE("Execution policy overloads")
+    {
+        // Several policy blocks plus a padded tail
+        const auto data = make_pattern(5 * 48 * 1024 + 2, 13);
+
+        const auto expected = base64::base64_encode(data);
+        REQUIRE(expected.has_value());
+
+        auto encoded = base64::base64_encode(std::execution::par, data);
+        REQUIRE(encoded.has_value());
+        CHECK(*encoded == *expected);
+
+        auto decoded = base64::base64_decode(std::execution::par_unseq,
+                                             *encoded);
+        REQUIRE(decoded.has_value());
+        CHECK(*decoded == data);
+
+        auto seq = base64::base64_encode(std::execution::seq,
+                                         string_to_bytes("A"),
+                                         base64::base64_chars_url_safe);
+        REQUIRE(seq.has_value());
+        CHECK(*seq == "QQ==");
+
+        std::string corrupted = *expected;
+        corrupted[10] = '=';
+        decoded = base64::base64_decode(std::execution::par, corrupted);
+        CHECK(!decoded.has_value());
+        CHECK(decoded.error() == base64::error::invalid_character);
+    }
+#endif
+
+    TEST_CASE("Thread pool batch encoding")
+    {
+        std::vector<std::vector<std::byte>> messages;
+        for (size_t i = 0; i < 2000; ++i)
+            messages.push_back(make_pattern(50 + i % 450, 1, i));
+        messages.emplace_back(); // Empty messages report their own error
+
+        std::vector<std::span<const std::byte>> inputs(messages.begin(),
+                                                       messages.end());
+
+        base64::thread_pool pool(base64::thread_pool_options{
+            .threads = 4, .cpu_affinity = {0}
+        });
+        CHECK(pool.size() == 4);
+
+        auto results = base64::base64_encode_batch(pool, inputs,
+                                                   base64::base64_chars,
+                                                   4096);
+        REQUIRE(results.size() == inputs.size());
+        for (size_t i = 0; i + 1 < results.size(); ++i)
+        {
+            REQUIRE(results[i].has_value());
+            CHECK(results[i] == base64::base64_encode(inputs[i]));
+        }
+        CHECK(results.back().error() == base64::error::empty_data);
+
+        auto shared = base64::base64_encode_batch(inputs);
+        CHECK(shared == results);
+
+        // A batch issued from a task helps run its own work instead of
+        // waiting on workers that are all busy
+        base64::thread_pool single(base64::thread_pool_options{
+            .threads = 1, .cpu_affinity = {}
+        });
+        std::latch nested_done(1);
+        std::vector<base64::encode_result> nested;
+        single.submit([&]
+        {
+            nested = base64::base64_encode_batch(single, inputs,
+                                                 base64::base64_chars, 4096);
+            nested_done.count_down();
+        });
+        nested_done.wait();
+        CHECK(nested == results);
+
+        // Shutdown drains queued work; later submissions are rejected
+        std::atomic<int> counter{0};
+        for (int i = 0; i < 100; ++i)
+            pool.submit([&counter] { ++counter; });
+        pool.shutdown();
+        CHECK(counter == 100);
+        CHECK(!pool.submit([] {}));
+    }
+
+    TEST_CASE("Columnar encoding and decoding")
+    {
+        const std::vector<std::string> rows = {
+            "Hello, World!", "", "a", "ab", "abc", std::string(5000, 'x')
+        };
+
+        std::vector<std::byte> data;
+        std::vector<int32_t> offsets{0};
+        for (const auto& row : rows)
+        {
+            const auto bytes = string_to_bytes(row);
+            data.insert(data.end(), bytes.begin(), bytes.end());
+            offsets.push_back(static_cast<int32_t>(data.size()));
+        }
+
+        for (const unsigned threads : {1u, 4u})
+        {
+            const base64::parallel_options options{threads, 0};
+            auto encoded = base64::base64_encode_column(
+                data, offsets, base64::base64_chars, options);
+            REQUIRE(encoded.has_value());
+            REQUIRE(encoded->offsets.size() == offsets.size());
+
+            for (size_t i = 0; i < rows.size(); ++i)
+            {
+                const auto row = std::string_view(encoded->data).substr(
+                    encoded->offsets[i],
+                    encoded->offsets[i + 1] - encoded->offsets[i]);
+                if (rows[i].empty())
+                    CHECK(row.empty());
+                else
+                    CHECK(row == *base64::base64_encode(string_to_bytes(rows[i])));
+            }
+
+            auto decoded = base64::base64_decode_column(
+                encoded->data, encoded->offsets, base64::base64_chars, options);
+            REQUIRE(decoded.has_value());
+            CHECK(decoded->data == data);
+            CHECK(decoded->offsets == offsets);
+        }
+
+        // 64-bit offsets
+        const std::vector<int64_t> large_offsets(offsets.begin(), offsets.end());
+        auto large = base64::base64_encode_column(data, large_offsets);
+        REQUIRE(large.has_value());
+        CHECK(large->offsets.back() == static_cast<int64_t>(large->data.size()));
+
+        // Malformed offsets and rows
+        const std::vector<int32_t> bad_offsets{0, 5, 3};
+        auto bad = base64::base64_encode_column(data, bad_offsets);
+        CHECK(!bad.has_value());
+        CHECK(bad.error() == base64::error::invalid_length);
+
+        // Columns of only empty rows produce an empty data buffer
+        const std::vector<int32_t> empty_offsets{0, 0, 0};
+        auto empty = base64::base64_decode_column("", empty_offsets);
+        REQUIRE(empty.has_value());
+        CHECK(empty->data.empty());
+        CHECK(empty->offsets == empty_offsets);
+
+        const std::vector<int32_t> string_offsets{0, 4, 8};
+        auto invalid = base64::base64_decode_column("QUJD!!!!", string_offsets);
+        CHECK(!invalid.has_value());
+        CHECK(invalid.error() == base64::error::invalid_character);
+    }
+
     TEST_SUITE("File Operations")
     {
         class temp_file
@@ -350,6 +599,989 @@ TEST_SUITE("Base64 Encoding and Decoding")
                 CHECK(encoded.find('+') == std::string::npos);
                 CHECK(encoded.find('/') == std::string::npos);
             }
+
+            TEST_CASE("Mapped and streamed file encoding agree")
+            {
+                // Sizes just below and above the memory-mapping threshold
+                for (const size_t size : {64 * 1024 - 1, 64 * 1024 + 1})
+                {
+                    const auto data = make_pattern(size, 5);
+
+                    temp_file file(data);
+                    auto result = base64::base64_encode_file(file.path());
+                    REQUIRE(result.has_value());
+                    CHECK(*result == base64::base64_encode(data).value());
+                }
+            }
+
+            TEST_CASE("File decoding")
+            {
+                const auto data = make_pattern(100 * 1024 + 2, 11);
+
+                const auto encoded = base64::base64_encode(data);
+                REQUIRE(encoded.has_value());
+                temp_file encoded_file(string_to_bytes(*encoded));
+                temp_file output_file({});
+
+                // Chunk sizes that split quads at every possible offset
+                for (const size_t chunk_size : {1, 3, 5, 6, 7, 8, 4096, 65536})
+                {
+                    auto decoded = base64::base64_decode_file(
+                        encoded_file.path(), base64::base64_chars, chunk_size);
+                    REQUIRE(decoded.has_value());
+                    CHECK(*decoded == data);
+
+                    auto error = base64::base64_decode_file_to_file(
+                        encoded_file.path(), output_file.path(),
+                        base64::base64_chars, chunk_size);
+                    CHECK(!error);
+                    CHECK(read_file(output_file.path()) == bytes_to_string(data));
+                }
+
+                temp_file short_file(string_to_bytes("SGVsbG8"));
+                auto result = base64::base64_decode_file(short_file.path());
+                CHECK(!result.has_value());
+                CHECK(result.error() == base64::error::invalid_length);
+
+                temp_file invalid_file(string_to_bytes("SGVsbG8hQQ==SGVs"));
+                result = base64::base64_decode_file(invalid_file.path(),
+                                                    base64::base64_chars, 4);
+                CHECK(!result.has_value());
+                CHECK(result.error() == base64::error::invalid_character);
+
+                auto error = base64::base64_decode_file_to_file(
+                    "nonexistent.file", output_file.path());
+                CHECK(error == base64::error::file_not_found);
+            }
+
+            TEST_CASE("Parallel file to file encoding")
+            {
+                const auto data = make_pattern(1024 * 1024 + 2, 29);
+
+                temp_file input_file(data);
+                temp_file output_file(string_to_bytes(std::string(5000000, '#')));
+                const auto expected = base64::base64_encode(data);
+                REQUIRE(expected.has_value());
+
+                // A longer pre-existing output must be truncated to the exact size
+                for (const unsigned threads : {1u, 3u, 8u})
+                {
+                    auto error = base64::base64_encode_file_to_file(
+                        input_file.path(), output_file.path(),
+                        base64::parallel_options{threads, 0});
+                    CHECK(!error);
+                    CHECK(read_file(output_file.path()) == *expected);
+                }
+            }
+
+            TEST_CASE("Parallel file decoding")
+            {
+                const auto data = make_pattern(1024 * 1024 + 1, 3);
+
+                const auto encoded = base64::base64_encode(data);
+                REQUIRE(encoded.has_value());
+                temp_file encoded_file(string_to_bytes(*encoded));
+                temp_file output_file({});
+
+                for (const unsigned threads : {1u, 4u})
+                {
+                    auto result = base64::base64_decode_file_to_file(
+                        encoded_file.path(), output_file.path(),
+                        base64::parallel_options{threads, 0});
+                    CHECK(result.has_value());
+                    CHECK(read_file(output_file.path()) == bytes_to_string(data));
+                }
+
+                // Two corruptions: the lowest offset is reported
+                std::string corrupted = *encoded;
+                corrupted[900000] = '*';
+                corrupted[123457] = '=';
+                temp_file corrupted_file(string_to_bytes(corrupted));
+
+                auto result = base64::base64_decode_file_to_file(
+                    corrupted_file.path(), output_file.path(),
+                    base64::parallel_options{4, 0});
+                REQUIRE(!result.has_value());
+                CHECK(result.error().error == base64::error::invalid_character);
+                CHECK(result.error().invalid_offset == 123457);
+
+                auto missing = base64::base64_decode_file_to_file(
+                    "missing_file", output_file.path(), base64::parallel_options{});
+                REQUIRE(!missing.has_value());
+                CHECK(missing.error().error == base64::error::file_not_found);
+                CHECK(!missing.error().invalid_offset);
+            }
+
+            TEST_CASE("Asynchronous file engine")
+            {
+                const auto data = make_pattern(1024 * 1024 + 1, 37);
+
+                temp_file input_file(data);
+                temp_file encoded_file({});
+                temp_file decoded_file({});
+                const auto expected = base64::base64_encode(data);
+                REQUIRE(expected.has_value());
+
+                // io_uring where async_io_supported(), the blocking fallback
+                // otherwise; the output must be the same either way
+                for (const base64::async_io_options options : {
+                         base64::async_io_options{},
+                         base64::async_io_options{1, 3000},
+                         base64::async_io_options{32, 4096}
+                     })
+                {
+                    auto error = base64::base64_encode_file_to_file(
+                        input_file.path(), encoded_file.path(), options);
+                    CHECK(!error);
+                    CHECK(read_file(encoded_file.path()) == *expected);
+
+                    error = base64::base64_decode_file_to_file(
+                        encoded_file.path(), decoded_file.path(), options);
+                    CHECK(!error);
+                    CHECK(read_file(decoded_file.path()) == bytes_to_string(data));
+                }
+
+                std::string corrupted = *expected;
+                corrupted[777777] = '?';
+                temp_file corrupted_file(string_to_bytes(corrupted));
+                auto error = base64::base64_decode_file_to_file(
+                    corrupted_file.path(), decoded_file.path(),
+                    base64::async_io_options{});
+                CHECK(error == base64::error::invalid_character);
+            }
+
+            TEST_CASE("Direct I/O file encoding")
+            {
+                // Whole chunks plus an unaligned tail, and a single short chunk
+                for (const size_t size : {size_t{3 * 12288 + 100}, size_t{5}})
+                {
+                    const auto data = make_pattern(size, 41);
+
+                    temp_file input_file(data);
+                    temp_file output_file({});
+
+                    auto error = base64::base64_encode_file_to_file(
+                        input_file.path(), output_file.path(),
+                        base64::direct_io_options{12288});
+                    CHECK(!error);
+                    CHECK(read_file(output_file.path()) ==
+                        base64::base64_encode(data).value());
+                }
+            }
+
+#if BASE64_POSIX_IO
+            TEST_CASE("Descriptor encoding and decoding")
+            {
+                const auto data = make_pattern(300 * 1024 + 7, 29);
+
+                temp_file input_file(data);
+                const std::string encoded = base64::base64_encode(data).value();
+
+                SUBCASE("File into a pipe")
+                {
+                    // Plain writes, and vmsplice() for a reader that copies out
+                    for (const bool vmsplice : {false, true})
+                    {
+                        int pipe_fds[2];
+                        REQUIRE(::pipe(pipe_fds) == 0);
+
+                        std::string piped;
+                        std::thread reader([&]
+                        {
+                            char buffer[4096];
+                            ssize_t got;
+                            while ((got = ::read(pipe_fds[0], buffer, sizeof(buffer))) > 0)
+                                piped.append(buffer, static_cast<size_t>(got));
+                        });
+
+                        const int input_fd = ::open(input_file.path().c_str(), O_RDONLY);
+                        REQUIRE(input_fd >= 0);
+                        auto error = base64::base64_encode_fd(
+                            input_fd, pipe_fds[1],
+                            base64::fd_encode_options{.chunk_size = 48 * 1024,
+                                                      .vmsplice = vmsplice});
+                        ::close(input_fd);
+                        ::close(pipe_fds[1]);
+                        reader.join();
+                        ::close(pipe_fds[0]);
+
+                        CHECK(!error);
+                        CHECK(piped == encoded);
+                    }
+                }
+
+                SUBCASE("Pipe into a file")
+                {
+                    int pipe_fds[2];
+                    REQUIRE(::pipe(pipe_fds) == 0);
+
+                    std::thread writer([&]
+                    {
+                        CHECK(::write(pipe_fds[1], encoded.data(), encoded.size()) ==
+                            static_cast<ssize_t>(encoded.size()));
+                        ::close(pipe_fds[1]);
+                    });
+
+                    temp_file output_file({});
+                    const int output_fd = ::open(output_file.path().c_str(),
+                                                 O_WRONLY | O_TRUNC);
+                    REQUIRE(output_fd >= 0);
+                    auto error = base64::base64_decode_fd(pipe_fds[0], output_fd);
+                    ::close(output_fd);
+                    writer.join();
+                    ::close(pipe_fds[0]);
+
+                    CHECK(!error);
+                    const auto decoded = read_file(output_file.path());
+                    CHECK(decoded.size() == data.size());
+                    CHECK(std::memcmp(decoded.data(), data.data(), data.size()) == 0);
+                }
+            }
+#endif
+
+#if BASE64_POSIX_IO
+            TEST_CASE("Inputs without a reliable size")
+            {
+                const auto data = make_pattern(200 * 1024 + 2, 13);
+                const std::string encoded = base64::base64_encode(data).value();
+
+                temp_file fifo({});
+                std::filesystem::remove(fifo.path());
+                REQUIRE(::mkfifo(fifo.path().c_str(), 0600) == 0);
+
+                const auto feed = [&fifo](const std::string_view content)
+                {
+                    return std::thread([&fifo, content]
+                    {
+                        std::ofstream writer(fifo.path(), std::ios::binary);
+                        writer.write(content.data(),
+                                     static_cast<std::streamsize>(content.size()));
+                    });
+                };
+
+                SUBCASE("Encoding a FIFO")
+                {
+                    auto writer = feed({reinterpret_cast<const char*>(data.data()),
+                                        data.size()});
+                    auto result = base64::base64_encode_file(fifo.path());
+                    writer.join();
+
+                    REQUIRE(result.has_value());
+                    CHECK(*result == encoded);
+                }
+
+                SUBCASE("Decoding a FIFO to a file")
+                {
+                    temp_file output_file({});
+                    auto writer = feed(encoded);
+                    auto result = base64::base64_decode_file_to_file(
+                        fifo.path(), output_file.path(), base64::parallel_options{});
+                    writer.join();
+
+                    CHECK(result.has_value());
+                    const auto decoded = read_file(output_file.path());
+                    CHECK(decoded.size() == data.size());
+                    CHECK(std::memcmp(decoded.data(), data.data(), data.size()) == 0);
+                }
+
+                SUBCASE("Streamed decoding locates invalid characters")
+                {
+                    // Small enough for the pipe buffer, so the writer never
+                    // blocks once the reader stops early
+                    std::string corrupted = encoded.substr(0, 4000);
+                    corrupted[2999] = '*';
+
+                    temp_file output_file({});
+                    auto writer = feed(corrupted);
+                    auto result = base64::base64_decode_file_to_file(
+                        fifo.path(), output_file.path(), base64::parallel_options{});
+                    writer.join();
+
+                    REQUIRE(!result.has_value());
+                    CHECK(result.error().error == base64::error::invalid_character);
+                    CHECK(result.error().invalid_offset == 2999);
+                }
+
+                SUBCASE("Size limit applies while reading")
+                {
+                    // Small enough for the pipe buffer, so the writer never
+                    // blocks on a reader that gave up
+                    auto writer = feed({reinterpret_cast<const char*>(data.data()),
+                                        4096});
+                    auto result = base64::base64_encode_file(
+                        fifo.path(), base64::base64_chars,
+                        base64::detail::default_chunk_size, 1024);
+                    writer.join();
+
+                    CHECK(result.error() == base64::error::file_too_large);
+                }
+
+                SUBCASE("Procfs file reporting size 0")
+                {
+                    if (std::filesystem::exists("/proc/version"))
+                    {
+                        auto result = base64::base64_encode_file("/proc/version");
+                        REQUIRE(result.has_value());
+
+                        const auto decoded = base64::base64_decode(*result);
+                        REQUIRE(decoded.has_value());
+                        CHECK(std::string(reinterpret_cast<const char*>(
+                                              decoded->data()), decoded->size()) ==
+                            read_file("/proc/version"));
+                    }
+                }
+            }
+#endif
+
+            TEST_CASE("File size limit is opt-in")
+            {
+                // Sparse, so the input costs no disk space
+                temp_file input_file({});
+                std::filesystem::resize_file(input_file.path(), 150 * 1024 * 1024 + 1);
+
+                temp_file output_file({});
+
+                CHECK(!base64::base64_encode_file_to_file(input_file.path(),
+                                                          output_file.path()));
+                CHECK(std::filesystem::file_size(output_file.path()) ==
+                    (150 * 1024 * 1024 + 1 + 2) / 3 * 4);
+                CHECK(base64::base64_encode_file_to_file(
+                        input_file.path(), output_file.path(), base64::base64_chars,
+                        base64::detail::default_chunk_size, 100 * 1024 * 1024) ==
+                    base64::error::file_too_large);
+            }
+
+            TEST_CASE("Automatic chunk sizing")
+            {
+                const auto data = make_pattern(300 * 1024 + 1, 7);
+                temp_file input_file(data);
+
+                const auto sizing = base64::auto_chunk_sizing(input_file.path());
+                CHECK(sizing.l1_cache_size > 0);
+                CHECK(sizing.l2_cache_size > 0);
+                CHECK(sizing.io_block_size > 0);
+                CHECK(sizing.chunk_size % (3 * sizing.io_block_size) == 0);
+                CHECK(sizing.chunk_size >= sizing.l1_cache_size);
+
+                auto encoded = base64::base64_encode_file(
+                    input_file.path(), base64::base64_chars, base64::auto_chunk_size);
+                REQUIRE(encoded.has_value());
+                CHECK(*encoded == base64::base64_encode(data).value());
+
+                temp_file output_file({});
+                CHECK(!base64::base64_encode_file_to_file(
+                    input_file.path(), output_file.path(), base64::base64_chars,
+                    base64::auto_chunk_size));
+                CHECK(read_file(output_file.path()) == *encoded);
+            }
+
+            TEST_CASE("Batch file encoding")
+            {
+                const auto root = std::filesystem::temp_directory_path() /
+                    ("base64_batch_" + std::to_string(
+                        std::chrono::steady_clock::now().time_since_epoch().count()));
+                const auto input_dir = root / "in";
+                const auto output_dir = root / "out";
+                std::filesystem::create_directories(input_dir / "nested");
+
+                std::vector<std::vector<std::byte>> contents;
+                std::vector<base64::file_job> jobs;
+                for (size_t size : {size_t{1}, size_t{2}, size_t{3}, size_t{1000},
+                                    size_t{70000}, size_t{400 * 1024 + 1}})
+                {
+                    auto data = make_pattern(size, 1, size);
+
+                    const auto name = (size % 2 ? input_dir : input_dir / "nested") /
+                        ("file" + std::to_string(size));
+                    std::ofstream(name, std::ios::binary).write(
+                        reinterpret_cast<const char*>(data.data()),
+                        static_cast<std::streamsize>(data.size()));
+                    jobs.push_back({name, root / ("list" + std::to_string(size))});
+                    contents.push_back(std::move(data));
+                }
+                jobs.push_back({root / "missing", root / "missing.b64"});
+
+                // Small thresholds so that grouping and splitting both happen
+                const base64::file_batch_options options{
+                    .group_bytes = 4096, .split_bytes = 100 * 1024
+                };
+                base64::thread_pool pool(base64::thread_pool_options{
+                    .threads = 4, .cpu_affinity = {}
+                });
+
+                SUBCASE("File list")
+                {
+                    const auto errors = base64::base64_encode_files(
+                        pool, jobs, base64::base64_chars, options);
+                    REQUIRE(errors.size() == jobs.size());
+                    for (size_t i = 0; i < contents.size(); ++i)
+                    {
+                        CHECK(!errors[i]);
+                        CHECK(read_file(jobs[i].output) ==
+                            base64::base64_encode(contents[i]).value());
+                    }
+                    CHECK(errors.back() == base64::error::file_not_found);
+                }
+
+                SUBCASE("From a task of the same pool")
+                {
+                    // The only worker is busy running the batch call itself
+                    base64::thread_pool single(base64::thread_pool_options{
+                        .threads = 1, .cpu_affinity = {}
+                    });
+                    std::latch finished(1);
+                    std::vector<std::error_code> errors;
+                    single.submit([&]
+                    {
+                        errors = base64::base64_encode_files(
+                            single, jobs, base64::base64_chars, options);
+                        finished.count_down();
+                    });
+                    finished.wait();
+
+                    REQUIRE(errors.size() == jobs.size());
+                    for (size_t i = 0; i < contents.size(); ++i)
+                    {
+                        CHECK(!errors[i]);
+                        CHECK(read_file(jobs[i].output) ==
+                            base64::base64_encode(contents[i]).value());
+                    }
+                }
+
+                SUBCASE("Directory tree")
+                {
+                    const auto results = base64::base64_encode_directory(
+                        pool, input_dir, output_dir, ".b64", base64::base64_chars,
+                        options);
+                    REQUIRE(results.has_value());
+                    CHECK(results->size() == contents.size());
+                    for (const auto& [job, error] : *results)
+                    {
+                        CHECK(!error);
+                        const auto input = read_file(job.input);
+                        CHECK(read_file(job.output) == base64::base64_encode(
+                            std::as_bytes(std::span(input))).value());
+                    }
+                    CHECK(std::filesystem::exists(output_dir / "nested" / "file2.b64"));
+
+                    CHECK(!base64::base64_encode_directory(root / "missing", output_dir));
+                }
+
+                std::filesystem::remove_all(root);
+            }
+
+            TEST_CASE("Verifying a file against its encoding")
+            {
+                const auto data = make_pattern(100 * 1024 + 1, 11);
+                const std::string encoded = base64::base64_encode(data).value();
+
+                temp_file data_file(data);
+                const auto encoded_file_with = [](const std::string& text)
+                {
+                    const auto bytes = std::as_bytes(std::span(text));
+                    return temp_file({bytes.begin(), bytes.end()});
+                };
+
+                auto matching = encoded_file_with(encoded);
+                auto result = base64::base64_verify_file(data_file.path(),
+                                                         matching.path());
+                REQUIRE(result.has_value());
+                CHECK(!result->has_value());
+
+                std::string corrupted = encoded;
+                corrupted[70000] = corrupted[70000] == 'A' ? 'B' : 'A';
+                auto corrupted_file = encoded_file_with(corrupted);
+                result = base64::base64_verify_file(data_file.path(),
+                                                    corrupted_file.path(),
+                                                    base64::base64_chars, 3000);
+                REQUIRE(result.has_value());
+                CHECK(result->value() == 70000);
+
+                auto truncated = encoded_file_with(encoded.substr(0, 1000));
+                result = base64::base64_verify_file(data_file.path(), truncated.path());
+                REQUIRE(result.has_value());
+                CHECK(result->value() == 1000);
+
+                auto extended = encoded_file_with(encoded + "\n");
+                result = base64::base64_verify_file(data_file.path(), extended.path());
+                REQUIRE(result.has_value());
+                CHECK(result->value() == encoded.size());
+            }
+
+            TEST_CASE("Byte range encoding and resuming")
+            {
+                const auto data = make_pattern(10000, 17);
+                const std::string encoded = base64::base64_encode(data).value();
+                temp_file input_file(data);
+
+                SUBCASE("Ranges out of order add up to the whole encoding")
+                {
+                    temp_file output_file({});
+                    auto last = base64::base64_encode_file_range(
+                        input_file.path(), output_file.path(), 6000);
+                    REQUIRE(last.has_value());
+                    CHECK(last->bytes_consumed == data.size());
+                    CHECK(last->bytes_emitted == encoded.size());
+
+                    auto first = base64::base64_encode_file_range(
+                        input_file.path(), output_file.path(), 0, 6000,
+                        base64::base64_chars, 999);
+                    REQUIRE(first.has_value());
+                    CHECK(first->bytes_consumed == 6000);
+                    CHECK(first->bytes_emitted == 8000);
+
+                    CHECK(read_file(output_file.path()) == encoded);
+                }
+
+                SUBCASE("Unaligned ranges are rejected")
+                {
+                    temp_file output_file({});
+                    CHECK(base64::base64_encode_file_range(
+                            input_file.path(), output_file.path(), 1).error() ==
+                        base64::error::invalid_length);
+                    CHECK(base64::base64_encode_file_range(
+                            input_file.path(), output_file.path(), 0, 100).error() ==
+                        base64::error::invalid_length);
+                }
+
+                SUBCASE("Resuming after an interruption")
+                {
+                    temp_file output_file({});
+                    auto checkpoint = base64::base64_encode_file_range(
+                        input_file.path(), output_file.path(), 0, 3000);
+                    REQUIRE(checkpoint.has_value());
+
+                    // A crash may leave unsynced, zero-filled data past it
+                    std::ofstream(output_file.path(), std::ios::binary | std::ios::app)
+                        << std::string(1001, '\0');
+
+                    auto done = base64::base64_resume_encode_file_to_file(
+                        input_file.path(), output_file.path(), *checkpoint);
+                    REQUIRE(done.has_value());
+                    CHECK(done->bytes_consumed == data.size());
+                    CHECK(read_file(output_file.path()) == encoded);
+
+                    // Resuming a finished job leaves it intact
+                    done = base64::base64_resume_encode_file_to_file(
+                        input_file.path(), output_file.path(), *done);
+                    REQUIRE(done.has_value());
+                    CHECK(read_file(output_file.path()) == encoded);
+
+                    // A default checkpoint starts over
+                    done = base64::base64_resume_encode_file_to_file(
+                        input_file.path(), output_file.path(), {});
+                    REQUIRE(done.has_value());
+                    CHECK(read_file(output_file.path()) == encoded);
+                }
+
+                SUBCASE("Resuming onto output that does not match the checkpoint")
+                {
+                    std::string damaged = encoded.substr(0, 4000);
+                    damaged[3990] = '\0';
+                    temp_file output_file(string_to_bytes(damaged));
+
+                    CHECK(base64::base64_resume_encode_file_to_file(
+                            input_file.path(), output_file.path(),
+                            base64::encode_checkpoint{3000, 4000}).error() ==
+                        base64::error::io_error);
+                    CHECK(base64::base64_resume_encode_file_to_file(
+                            input_file.path(), output_file.path(),
+                            base64::encode_checkpoint{6000, 8000}).error() ==
+                        base64::error::io_error);
+                    CHECK(base64::base64_resume_encode_file_to_file(
+                            input_file.path(), output_file.path(),
+                            base64::encode_checkpoint{3000, 4004}).error() ==
+                        base64::error::invalid_length);
+                }
+            }
+
+            TEST_CASE("Following a growing file")
+            {
+                const auto data = make_pattern(5000, 23);
+
+                temp_file input_file({});
+                temp_file output_file({});
+                const auto append = [&](const size_t first, const size_t last)
+                {
+                    std::ofstream(input_file.path(), std::ios::binary | std::ios::app)
+                        .write(reinterpret_cast<const char*>(data.data() + first),
+                               static_cast<std::streamsize>(last - first));
+                };
+
+                base64::tail_state saved;
+                {
+                    base64::tail_encoder follower(input_file.path(), output_file.path(),
+                                                  {}, base64::base64_chars, 100);
+                    CHECK(follower.poll().value() == 0);
+
+                    append(0, 1);
+                    CHECK(follower.poll().value() == 1);
+                    CHECK(follower.state().carry_size == 1);
+                    CHECK(read_file(output_file.path()).empty());
+
+                    append(1, 2000);
+                    CHECK(follower.poll().value() == 1999);
+                    saved = follower.state();
+                }
+
+                // A later run continues from the saved state
+                base64::tail_encoder follower(input_file.path(), output_file.path(),
+                                              saved, base64::base64_chars, 100);
+                append(2000, 5000);
+                CHECK(follower.poll().value() == 3000);
+                CHECK(!follower.finish());
+                CHECK(read_file(output_file.path()) == base64::base64_encode(data).value());
+
+                // The character set is copied, so a temporary may be passed
+                temp_file url_output({});
+                base64::tail_encoder url_follower(input_file.path(), url_output.path(), {},
+                                                  std::string(base64::base64_chars_url_safe));
+                CHECK(url_follower.poll().value() == data.size());
+                CHECK(!url_follower.finish());
+                CHECK(read_file(url_output.path()) ==
+                    base64::base64_encode(data, base64::base64_chars_url_safe).value());
+
+                // An invalid set is reported by every call
+                base64::tail_encoder invalid(input_file.path(), url_output.path(), {}, "ABC");
+                CHECK(invalid.poll().error() == base64::error::invalid_character_set_length);
+                CHECK(invalid.finish() == base64::error::invalid_character_set_length);
+
+                // An output that cannot be opened is not blamed on the input
+                base64::tail_encoder unwritable(input_file.path(),
+                                                input_file.path() / "missing" / "out");
+                CHECK(unwritable.poll().error() == base64::error::io_error);
+            }
+
+            TEST_CASE("Sharded encoding and decoding")
+            {
+                const auto data = make_pattern(100000, 19);
+                const std::string encoded = base64::base64_encode(data).value();
+                temp_file input_file(data);
+
+                const auto root = std::filesystem::temp_directory_path() /
+                    ("base64_shards_" + std::to_string(
+                        std::chrono::steady_clock::now().time_since_epoch().count()));
+                std::filesystem::create_directories(root);
+
+                // Not a multiple of 4, so it is rounded down to 30000
+                const auto manifest = base64::base64_encode_file_sharded(
+                    input_file.path(), root / "data",
+                    base64::shard_options{.shard_size = 30002, .threads = 3});
+                REQUIRE(manifest.has_value());
+                REQUIRE(manifest->shards.size() == 5);
+                CHECK(manifest->encoded_size == encoded.size());
+
+                std::string joined;
+                for (const auto& shard : manifest->shards)
+                {
+                    CHECK(shard.encoded_offset == joined.size());
+                    CHECK(shard.input_offset == joined.size() / 4 * 3);
+                    const auto part = read_file(root / shard.path);
+                    CHECK(part.size() == shard.size);
+                    joined += part;
+                }
+                CHECK(joined == encoded);
+
+                const auto output = root / "decoded";
+                CHECK(!base64::base64_decode_sharded(root / "data.manifest", output,
+                                                     base64::shard_options{.threads = 3}));
+                const auto decoded = read_file(output);
+                CHECK(decoded.size() == data.size());
+                CHECK(std::memcmp(decoded.data(), data.data(), data.size()) == 0);
+
+                // More parts in flight than pool threads
+                base64::thread_pool pool(base64::thread_pool_options{
+                    .threads = 1, .cpu_affinity = {}
+                });
+                std::filesystem::remove(output);
+                CHECK(!base64::base64_decode_sharded(pool, root / "data.manifest", output,
+                                                     base64::shard_options{.threads = 4}));
+                CHECK(read_file(output) == decoded);
+
+                // Part names must not leave the manifest's directory
+                const std::string original = read_file(root / "data.manifest");
+                for (const std::string name : {"../data.part00001", "/tmp/data.part00001",
+                                               "sub/data.part00001", ".."})
+                {
+                    std::string tampered = original;
+                    tampered.replace(tampered.find("data.part00001"), 14, name);
+                    std::ofstream(root / "data.manifest", std::ios::trunc) << tampered;
+                    CHECK(base64::base64_decode_sharded(root / "data.manifest", output) ==
+                        base64::error::io_error);
+                }
+                std::ofstream(root / "data.manifest", std::ios::trunc) << original;
+
+                std::filesystem::remove(root / manifest->shards[2].path);
+                CHECK(base64::base64_decode_sharded(root / "data.manifest", output) ==
+                    base64::error::file_not_found);
+
+                // A failed encoding removes the parts it wrote and the old manifest
+                std::filesystem::create_directory(root / "broken.part00002");
+                std::ofstream(root / "broken.manifest") << "stale";
+                CHECK(base64::base64_encode_file_sharded(
+                        input_file.path(), root / "broken",
+                        base64::shard_options{.shard_size = 30000, .threads = 3}).error() ==
+                    base64::error::io_error);
+                for (const char* part : {"broken.part00000", "broken.part00001",
+                                         "broken.part00003", "broken.part00004",
+                                         "broken.manifest"})
+                    CHECK(!std::filesystem::exists(root / part));
+                CHECK(std::filesystem::is_directory(root / "broken.part00002"));
+
+                std::filesystem::remove_all(root);
+            }
+
+            TEST_CASE("Durable file outputs")
+            {
+                const std::vector<std::byte> data{
+                    std::byte{'d'}, std::byte{'u'}, std::byte{'r'}, std::byte{'a'},
+                    std::byte{'b'}, std::byte{'l'}, std::byte{'e'}
+                };
+                const auto root = std::filesystem::temp_directory_path() /
+                    ("base64_durable_" + std::to_string(
+                        std::chrono::steady_clock::now().time_since_epoch().count()));
+                std::filesystem::create_directories(root);
+                temp_file input_file(data);
+
+                const auto entries = [](const std::filesystem::path& directory)
+                {
+                    return std::distance(std::filesystem::directory_iterator(directory),
+                                         std::filesystem::directory_iterator());
+                };
+
+                SUBCASE("Atomic replace with per-file sync")
+                {
+                    const auto output = root / "out.b64";
+                    std::ofstream(output) << "previous";
+
+                    const base64::durability_options durability{
+                        .atomic_rename = true, .sync = base64::sync_policy::per_file
+                    };
+                    CHECK(!base64::base64_encode_file_to_file(
+                        input_file.path(), output, durability));
+                    CHECK(read_file(output) == "ZHVyYWJsZQ==");
+                    CHECK(entries(root) == 1);
+
+                    // A failed encode leaves the destination as it was
+                    CHECK(base64::base64_encode_file_to_file(
+                            root / "missing", output, durability) ==
+                        base64::error::file_not_found);
+                    CHECK(read_file(output) == "ZHVyYWJsZQ==");
+                    CHECK(entries(root) == 1);
+                }
+
+                SUBCASE("Batch synced once and published")
+                {
+                    const auto batch_dir = root / "batch";
+                    std::filesystem::create_directories(batch_dir);
+                    std::vector<base64::file_job> jobs;
+                    for (int i = 0; i < 5; ++i)
+                        jobs.push_back({input_file.path(), batch_dir / (std::to_string(i) + ".b64")});
+
+                    base64::file_batch_options options;
+                    options.durability = {
+                        .atomic_rename = true, .sync = base64::sync_policy::per_batch
+                    };
+                    for (const auto& error : base64::base64_encode_files(
+                             jobs, base64::base64_chars, options))
+                        CHECK(!error);
+
+                    for (const auto& job : jobs)
+                        CHECK(read_file(job.output) == "ZHVyYWJsZQ==");
+                    CHECK(entries(batch_dir) == 5);
+                }
+
+                std::filesystem::remove_all(root);
+            }
+
+            TEST_CASE("File encode cache")
+            {
+                std::vector<std::byte> data(1000, std::byte{0x5A});
+                temp_file first(data);
+                data.push_back(std::byte{0x01});
+                temp_file second(data);
+
+                // Room for the first encoding only
+                base64::file_encode_cache cache(1500);
+
+                auto miss = cache.encode(first.path());
+                REQUIRE(miss.has_value());
+                auto hit = cache.encode(first.path());
+                REQUIRE(hit.has_value());
+                CHECK(hit->get() == miss->get());
+                CHECK(**hit == base64::base64_encode_file(first.path()).value());
+
+                auto stats = cache.stats();
+                CHECK(stats.hits == 1);
+                CHECK(stats.misses == 1);
+                CHECK(stats.entries == 1);
+                CHECK(stats.bytes == (*hit)->size());
+
+                // Caching the second file evicts the first
+                REQUIRE(cache.encode(second.path()).has_value());
+                CHECK(cache.stats().evictions == 1);
+                CHECK(cache.stats().entries == 1);
+
+                // A rewritten file is a different entry
+                std::ofstream(second.path(), std::ios::binary | std::ios::app) << 'x';
+                auto changed = cache.encode(second.path());
+                REQUIRE(changed.has_value());
+                CHECK(**changed == base64::base64_encode_file(second.path()).value());
+                CHECK(cache.stats().hits == 1);
+
+                CHECK(cache.encode("missing_file").error() == base64::error::file_not_found);
+
+                // The character set is copied, so a temporary may be passed
+                base64::file_encode_cache url_cache(
+                    1500, std::string(base64::base64_chars_url_safe));
+                auto url = url_cache.encode(first.path());
+                REQUIRE(url.has_value());
+                CHECK(**url == base64::base64_encode_file(first.path(),
+                                                          base64::base64_chars_url_safe).value());
+            }
+
+            TEST_CASE("Memoized encoding")
+            {
+                base64::encode_memo memo(64 * 1024, 4);
+
+                std::vector<std::vector<std::byte>> payloads;
+                for (size_t size : {size_t{1}, size_t{7}, size_t{8}, size_t{9}, size_t{1000}})
+                    payloads.push_back(make_pattern(size, 3, size));
+
+                std::vector<std::thread> threads;
+                for (int t = 0; t < 4; ++t)
+                {
+                    threads.emplace_back([&]
+                    {
+                        for (int round = 0; round < 50; ++round)
+                        {
+                            for (const auto& payload : payloads)
+                            {
+                                auto encoded = memo.encode(payload);
+                                REQUIRE(encoded.has_value());
+                                CHECK(**encoded == base64::base64_encode(payload).value());
+                            }
+                        }
+                    });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+
+                const auto stats = memo.stats();
+                CHECK(stats.hits + stats.misses == 4 * 50 * payloads.size());
+                CHECK(stats.misses >= payloads.size());
+                CHECK(stats.entries == payloads.size());
+
+                // Equal content in a different buffer hits the same entry
+                const auto copy = payloads.back();
+                CHECK(memo.encode(copy)->get() == memo.encode(payloads.back())->get());
+
+                CHECK(memo.encode({}).error() == base64::error::empty_data);
+
+                SUBCASE("Colliding inputs are verified")
+                {
+                    // Every input hashes alike, so only the stored copy tells them apart
+                    base64::encode_memo colliding(
+                        64 * 1024, 1, std::string(base64::base64_chars),
+                        [](std::span<const std::byte>) -> std::uint64_t { return 42; });
+
+                    const auto first = make_pattern(30, 5);
+                    const auto second = make_pattern(30, 5, 1);
+                    REQUIRE(colliding.encode(first).has_value());
+                    auto other = colliding.encode(second);
+                    REQUIRE(other.has_value());
+                    CHECK(**other == base64::base64_encode(second).value());
+
+                    const auto& observed = colliding;
+                    const auto collided = observed.stats();
+                    CHECK(collided.hits == 0);
+                    CHECK(collided.misses == 2);
+                }
+            }
+
+            TEST_CASE("Huge page backed encoding")
+            {
+                // Large allocations are mapped, small ones use the heap
+                base64::huge_page_allocator<std::byte> byte_allocator;
+                for (size_t size : {size_t{4096}, size_t{3 * 1024 * 1024 + 5}})
+                {
+                    std::byte* data = byte_allocator.allocate(size);
+                    std::fill_n(data, size, std::byte{0xA5});
+                    CHECK(data[size - 1] == std::byte{0xA5});
+                    byte_allocator.deallocate(data, size);
+                }
+
+                const auto data = make_pattern(2 * 1024 * 1024, 7);
+                const auto expected = base64::base64_encode(data).value();
+
+                base64::huge_page_allocator<char> allocator;
+                auto encoded = base64::base64_encode(data, allocator);
+                REQUIRE(encoded.has_value());
+                CHECK(std::string_view(*encoded) == expected);
+
+                // Mapped and streamed file paths
+                temp_file file(data);
+                auto from_file = base64::base64_encode_file(file.path(), allocator);
+                REQUIRE(from_file.has_value());
+                CHECK(std::string_view(*from_file) == expected);
+
+                // Below the mapping threshold, with a huge page chunk buffer
+                const std::vector<std::byte> small(data.begin(), data.begin() + 60000);
+                temp_file small_file(small);
+                auto streamed = base64::base64_encode_file(
+                    small_file.path(), allocator, base64::base64_chars, 4 * 1024 * 1024);
+                REQUIRE(streamed.has_value());
+                CHECK(std::string_view(*streamed) == base64::base64_encode(small).value());
+
+                CHECK(base64::base64_encode({}, allocator).error() == base64::error::empty_data);
+
+                // Decoding into huge page backed buffers
+                base64::huge_page_bytes decoded =
+                    base64::base64_decode(expected, byte_allocator).value();
+                CHECK(std::ranges::equal(decoded, data));
+
+                const auto text = std::as_bytes(std::span(expected));
+                temp_file encoded_file({text.begin(), text.end()});
+                auto decoded_file = base64::base64_decode_file(
+                    encoded_file.path(), byte_allocator, base64::base64_chars, 4 * 1024 * 1024);
+                REQUIRE(decoded_file.has_value());
+                CHECK(std::ranges::equal(*decoded_file, data));
+
+                CHECK(base64::base64_decode("", byte_allocator).error() ==
+                    base64::error::empty_data);
+                CHECK(base64::base64_decode("QQ=A", byte_allocator).error() ==
+                    base64::error::invalid_character);
+            }
+
+            TEST_CASE("Pipelined file to file encoding")
+            {
+                const auto data = make_pattern(300 * 1024 + 1, 17);
+
+                temp_file input_file(data);
+                temp_file output_file({});
+                const auto expected = base64::base64_encode(data);
+                REQUIRE(expected.has_value());
+
+                const std::vector<base64::pipeline_options> variants = {
+                    {1, 4096, 1},
+                    {3, 1000, 2},
+                    {4, 7 * 1024, 0},
+                    {}
+                };
+
+                for (const auto& options : variants)
+                {
+                    auto error = base64::base64_encode_file_to_file(
+                        input_file.path(), output_file.path(), options);
+                    CHECK(!error);
+                    CHECK(read_file(output_file.path()) == *expected);
+                }
+
+                auto error = base64::base64_encode_file_to_file(
+                    "nonexistent.file", output_file.path(),
+                    base64::pipeline_options{});
+                CHECK(error == base64::error::file_not_found);
+            }
         }
     }
 }
@@ -3,6 +3,9 @@
 
 #include "doctest/doctest.h"
 #include "../include/base64.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -22,6 +25,26 @@ namespace test_helpers
             bytes.size()
         };
     }
+
+    // size bytes of (start + i * stride) mod 256
+    inline std::vector<std::byte> make_pattern(const size_t size,
+                                               const size_t stride,
+                                               const size_t start = 0)
+    {
+        std::vector<std::byte> bytes(size);
+        for (size_t i = 0; i < size; ++i)
+            bytes[i] = std::byte{static_cast<unsigned char>(start + i * stride)};
+        return bytes;
+    }
+
+    inline std::string read_file(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return {
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()
+        };
+    }
 }
 
 